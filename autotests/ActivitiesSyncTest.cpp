@@ -0,0 +1,147 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "ActivitiesSyncTest.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTest>
+
+#include <PlasmaActivities/Consumer>
+#include <PlasmaActivities/Controller>
+
+#include <activitiessync_p.h>
+
+#include <memory>
+
+ActivitiesSyncTest::ActivitiesSyncTest(QObject *parent)
+    : Test(parent)
+{
+}
+
+void ActivitiesSyncTest::initTestCase()
+{
+}
+
+void ActivitiesSyncTest::testFallback()
+{
+    if (isActivityManagerRunning()) {
+        QSKIP("The activity manager is running");
+    }
+
+    TEST_CHUNK(QStringLiteral("Waiting for the activity manager for a limited time"))
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QCOMPARE(ActivitiesSync::currentActivity(), QString());
+        QVERIFY(timer.elapsed() < 1000);
+    }
+
+    TEST_CHUNK(QStringLiteral("Not waiting again"))
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QCOMPARE(ActivitiesSync::currentActivity(), QString());
+        QCOMPARE(ActivitiesSync::cachedCurrentActivity(), QString());
+        QVERIFY(timer.elapsed() < 100);
+    }
+}
+
+void ActivitiesSyncTest::testReady()
+{
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    KActivities::Consumer kamd;
+
+    while (kamd.serviceStatus() == KActivities::Consumer::Unknown) {
+        QCoreApplication::processEvents();
+    }
+
+    TEST_CHUNK(QStringLiteral("Getting the current activity"))
+    {
+        QCOMPARE(ActivitiesSync::currentActivity(), kamd.currentActivity());
+    }
+
+    TEST_CHUNK(QStringLiteral("Being told that the current activity is known"))
+    {
+        QObject context;
+        bool ready = false;
+
+        ActivitiesSync::whenReady(&context, [&ready] {
+            ready = true;
+        });
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(ready, 5000);
+        QCOMPARE(ActivitiesSync::cachedCurrentActivity(), kamd.currentActivity());
+    }
+}
+
+void ActivitiesSyncTest::testActivityChanges()
+{
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    KActivities::Consumer kamd;
+
+    while (kamd.serviceStatus() == KActivities::Consumer::Unknown) {
+        QCoreApplication::processEvents();
+    }
+
+    const auto originalActivity = kamd.currentActivity();
+
+    QString otherActivity;
+    for (const auto &activity : kamd.runningActivities()) {
+        if (activity != originalActivity) {
+            otherActivity = activity;
+            break;
+        }
+    }
+
+    if (otherActivity.isEmpty()) {
+        QSKIP("Switching the activities needs at least two running activities");
+    }
+
+    QStringList changes;
+    auto context = std::make_unique<QObject>();
+
+    ActivitiesSync::onCurrentActivityChanged(context.get(), [&changes](const QString &activity) {
+        changes << activity;
+    });
+
+    KActivities::Controller controller;
+
+    TEST_CHUNK(QStringLiteral("Following the current activity"))
+    {
+        controller.setCurrentActivity(otherActivity);
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(changes.contains(otherActivity), 5000);
+        QCOMPARE(ActivitiesSync::currentActivity(), otherActivity);
+    }
+
+    TEST_CHUNK(QStringLiteral("Forgetting the callback with its context"))
+    {
+        context.reset();
+
+        controller.setCurrentActivity(originalActivity);
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(ActivitiesSync::currentActivity() == originalActivity, 5000);
+
+        QCOMPARE(changes.last(), otherActivity);
+    }
+}
+
+void ActivitiesSyncTest::cleanupTestCase()
+{
+    Q_EMIT testFinished();
+}
+
+#include "moc_ActivitiesSyncTest.cpp"
@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef ACTIVITIESSYNCTEST_H
+#define ACTIVITIESSYNCTEST_H
+
+#include <common/test.h>
+
+class ActivitiesSyncTest : public Test
+{
+    Q_OBJECT
+public:
+    ActivitiesSyncTest(QObject *parent = nullptr);
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testFallback();
+    void testReady();
+    void testActivityChanges();
+
+    void cleanupTestCase();
+};
+
+#endif /* ACTIVITIESSYNCTEST_H */
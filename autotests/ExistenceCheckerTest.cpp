@@ -0,0 +1,139 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "ExistenceCheckerTest.h"
+
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <existencechecker_p.h>
+
+ExistenceCheckerTest::ExistenceCheckerTest(QObject *parent)
+    : Test(parent)
+{
+}
+
+void ExistenceCheckerTest::initTestCase()
+{
+}
+
+void ExistenceCheckerTest::testMountTable()
+{
+    using namespace ExistenceChecker::details;
+
+    TEST_CHUNK(QStringLiteral("Recognizing the remote filesystems"))
+    {
+        QVERIFY(isRemoteFileSystem("nfs4"));
+        QVERIFY(isRemoteFileSystem("cifs"));
+        QVERIFY(isRemoteFileSystem("fuse.sshfs"));
+        QVERIFY(isRemoteFileSystem("fuse.rclone"));
+
+        // These are backed by local block devices
+        QVERIFY(!isRemoteFileSystem("ext4"));
+        QVERIFY(!isRemoteFileSystem("btrfs"));
+        QVERIFY(!isRemoteFileSystem("fuseblk"));
+    }
+
+    TEST_CHUNK(QStringLiteral("Decoding the escaped mount points"))
+    {
+        QCOMPARE(decodeMountPath("/mnt/plain"), QStringLiteral("/mnt/plain"));
+        QCOMPARE(decodeMountPath("/mnt/with\\040space"), QStringLiteral("/mnt/with space"));
+        QCOMPARE(decodeMountPath("/mnt/with\\011tab"), QStringLiteral("/mnt/with\ttab"));
+        QCOMPARE(decodeMountPath("/mnt/not\\escaped"), QStringLiteral("/mnt/not\\escaped"));
+    }
+}
+
+void ExistenceCheckerTest::testMountBackoff()
+{
+    using namespace ExistenceChecker::details;
+
+    const QString fastMount = QStringLiteral("/ExistenceCheckerTest/fast");
+    const QString slowMount = QStringLiteral("/ExistenceCheckerTest/slow");
+
+    TEST_CHUNK(QStringLiteral("Checking a mount only once at a time"))
+    {
+        QVERIFY(claimMount(fastMount));
+
+        // A check that never finished, a stale mount for example,
+        // keeps the mount from being checked again
+        QVERIFY(!claimMount(fastMount));
+
+        // The other mounts do not wait for it
+        QVERIFY(claimMount(slowMount));
+
+        releaseMount(fastMount, false);
+        QVERIFY(claimMount(fastMount));
+        releaseMount(fastMount, false);
+    }
+
+    TEST_CHUNK(QStringLiteral("Leaving the slow mounts alone for a while"))
+    {
+        releaseMount(slowMount, true);
+        QVERIFY(!claimMount(slowMount));
+
+        QVERIFY(claimMount(fastMount));
+        releaseMount(fastMount, false);
+    }
+}
+
+void ExistenceCheckerTest::testMissingResources()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString existing = dir.filePath(QStringLiteral("existing"));
+    const QString missing = dir.filePath(QStringLiteral("missing"));
+
+    {
+        QFile file(existing);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    QObject context;
+    QStringList reported;
+    int calls = 0;
+
+    ExistenceChecker::findMissingResources(&context,
+                                           {existing, missing, QStringLiteral("test://not-a-path")},
+                                           [&](const QStringList &missingResources) {
+                                               reported << missingResources;
+                                               ++calls;
+                                           });
+
+    TEST_CHUNK(QStringLiteral("Reporting only the local paths that do not exist"))
+    {
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(calls > 0, 2000);
+        QTest::qWait(100);
+
+        QCOMPARE(reported, QStringList{missing});
+    }
+
+    TEST_CHUNK(QStringLiteral("Not calling back after the context is gone"))
+    {
+        calls = 0;
+
+        {
+            QObject shortLivedContext;
+            ExistenceChecker::findMissingResources(&shortLivedContext, {missing}, [&](const QStringList &) {
+                ++calls;
+            });
+        }
+
+        QTest::qWait(500);
+        QCOMPARE(calls, 0);
+    }
+}
+
+void ExistenceCheckerTest::cleanupTestCase()
+{
+    Q_EMIT testFinished();
+}
+
+#include "moc_ExistenceCheckerTest.cpp"
@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef EXISTENCECHECKERTEST_H
+#define EXISTENCECHECKERTEST_H
+
+#include <common/test.h>
+
+class ExistenceCheckerTest : public Test
+{
+    Q_OBJECT
+public:
+    ExistenceCheckerTest(QObject *parent = nullptr);
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testMountTable();
+    void testMountBackoff();
+    void testMissingResources();
+
+    void cleanupTestCase();
+};
+
+#endif /* EXISTENCECHECKERTEST_H */
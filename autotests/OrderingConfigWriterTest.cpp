@@ -0,0 +1,89 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "OrderingConfigWriterTest.h"
+
+#include <QString>
+#include <QStringList>
+#include <QTest>
+
+#include <KConfig>
+#include <KConfigGroup>
+
+#include <orderingconfigwriter_p.h>
+
+OrderingConfigWriterTest::OrderingConfigWriterTest(QObject *parent)
+    : Test(parent)
+{
+}
+
+namespace
+{
+const auto s_delayedGroup = QStringLiteral("OrderingConfigWriterTest-delayed");
+const auto s_flushedGroup = QStringLiteral("OrderingConfigWriterTest-flushed");
+
+// Reads the order with a new config object, like the other
+// processes that share the file would
+QStringList savedOrder(const QString &group)
+{
+    KConfig config(QStringLiteral("kactivitymanagerd-statsrc"));
+    return KConfigGroup(&config, group).readEntry("kactivitiesLinkedItemsOrder", QStringList());
+}
+
+void removeGroups()
+{
+    KConfig config(QStringLiteral("kactivitymanagerd-statsrc"));
+    config.deleteGroup(s_delayedGroup);
+    config.deleteGroup(s_flushedGroup);
+    config.sync();
+}
+}
+
+void OrderingConfigWriterTest::initTestCase()
+{
+    removeGroups();
+}
+
+void OrderingConfigWriterTest::testDelayedWrites()
+{
+    const QStringList first{QStringLiteral("test://order1"), QStringLiteral("test://order2")};
+    const QStringList second{QStringLiteral("test://order2"), QStringLiteral("test://order1")};
+
+    TEST_CHUNK(QStringLiteral("Collecting the reorders"))
+    {
+        OrderingConfigWriter::schedule(s_delayedGroup, first);
+        OrderingConfigWriter::schedule(s_delayedGroup, second);
+
+        QCOMPARE(savedOrder(s_delayedGroup), QStringList());
+    }
+
+    TEST_CHUNK(QStringLiteral("Saving only the last order"))
+    {
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(!savedOrder(s_delayedGroup).isEmpty(), 3000);
+        QCOMPARE(savedOrder(s_delayedGroup), second);
+    }
+}
+
+void OrderingConfigWriterTest::testFlush()
+{
+    const QStringList order{QStringLiteral("test://order3"), QStringLiteral("test://order4")};
+
+    OrderingConfigWriter::schedule(s_flushedGroup, order);
+    QCOMPARE(savedOrder(s_flushedGroup), QStringList());
+
+    // The pending writes do not wait for the timer
+    OrderingConfigWriter::flush();
+    QCOMPARE(savedOrder(s_flushedGroup), order);
+}
+
+void OrderingConfigWriterTest::cleanupTestCase()
+{
+    removeGroups();
+
+    Q_EMIT testFinished();
+}
+
+#include "moc_OrderingConfigWriterTest.cpp"
@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef ORDERINGCONFIGWRITERTEST_H
+#define ORDERINGCONFIGWRITERTEST_H
+
+#include <common/test.h>
+
+class OrderingConfigWriterTest : public Test
+{
+    Q_OBJECT
+public:
+    OrderingConfigWriterTest(QObject *parent = nullptr);
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testDelayedWrites();
+    void testFlush();
+
+    void cleanupTestCase();
+};
+
+#endif /* ORDERINGCONFIGWRITERTEST_H */
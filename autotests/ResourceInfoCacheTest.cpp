@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "ResourceInfoCacheTest.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <resourceinfocache_p.h>
+
+#include <common/database/Database.h>
+#include <common/database/schema/ResourcesDatabaseSchema.h>
+
+ResourceInfoCacheTest::ResourceInfoCacheTest(QObject *parent)
+    : Test(parent)
+{
+}
+
+void ResourceInfoCacheTest::testExistingResources()
+{
+    const auto resource = QStringLiteral("test://info-cache-existing");
+
+    TEST_CHUNK(QStringLiteral("Loading the information from the database"))
+    {
+        const auto info = ResourceInfoCache::find(resource);
+
+        QVERIFY(info.has_value());
+        QCOMPARE(info->title, QStringLiteral("Existing"));
+        QCOMPARE(info->mimetype, QStringLiteral("text/plain"));
+
+        QVERIFY(!ResourceInfoCache::isCachedAsMissing(resource));
+        QVERIFY(ResourceInfoCache::cachedResources().contains(resource));
+    }
+
+    TEST_CHUNK(QStringLiteral("Updating the cached information"))
+    {
+        ResourceInfoCache::updateTitle(resource, QStringLiteral("Renamed"));
+
+        QCOMPARE(ResourceInfoCache::cached(resource)->title, QStringLiteral("Renamed"));
+        QCOMPARE(ResourceInfoCache::cached(resource)->mimetype, QStringLiteral("text/plain"));
+    }
+}
+
+void ResourceInfoCacheTest::testMissingResources()
+{
+    const auto resource = QStringLiteral("test://info-cache-missing");
+
+    TEST_CHUNK(QStringLiteral("Remembering that the database has nothing"))
+    {
+        QVERIFY(!ResourceInfoCache::find(resource).has_value());
+
+        QVERIFY(ResourceInfoCache::isCachedAsMissing(resource));
+        QVERIFY(!ResourceInfoCache::cached(resource).has_value());
+        QVERIFY(!ResourceInfoCache::cachedResources().contains(resource));
+    }
+
+    TEST_CHUNK(QStringLiteral("Not updating the missing resources"))
+    {
+        ResourceInfoCache::updateTitle(resource, QStringLiteral("Missing"));
+
+        QVERIFY(ResourceInfoCache::isCachedAsMissing(resource));
+        QVERIFY(!ResourceInfoCache::cached(resource).has_value());
+    }
+
+    TEST_CHUNK(QStringLiteral("Replacing the missing entry"))
+    {
+        ResourceInfoCache::insert(resource, {QStringLiteral("Found"), QStringLiteral("text/html")});
+
+        QVERIFY(!ResourceInfoCache::isCachedAsMissing(resource));
+        QVERIFY(ResourceInfoCache::cachedResources().contains(resource));
+
+        const auto info = ResourceInfoCache::find(resource);
+        QVERIFY(info.has_value());
+        QCOMPARE(info->title, QStringLiteral("Found"));
+    }
+}
+
+void ResourceInfoCacheTest::initTestCase()
+{
+    QTemporaryDir dir(QDir::tempPath() + QStringLiteral("/KActivitiesStatsTest_ResourceInfoCacheTest_XXXXXX"));
+    dir.setAutoRemove(false);
+
+    if (!dir.isValid()) {
+        qFatal("Can not create a temporary directory");
+    }
+
+    const QString databaseFile = dir.path() + QStringLiteral("/database");
+
+    Common::ResourcesDatabaseSchema::overridePath(databaseFile);
+    qDebug() << "Creating database in " << databaseFile;
+
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    Common::ResourcesDatabaseSchema::initSchema(*database);
+
+    database->execQuery(
+        QStringLiteral("INSERT INTO  ResourceInfo (targettedResource, title, mimetype, autoTitle, autoMimetype) VALUES"
+                       "('test://info-cache-existing', 'Existing', 'text/plain', 1, 1 )"));
+}
+
+void ResourceInfoCacheTest::cleanupTestCase()
+{
+    Q_EMIT testFinished();
+}
+
+#include "moc_ResourceInfoCacheTest.cpp"
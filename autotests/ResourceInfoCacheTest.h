@@ -0,0 +1,27 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RESOURCEINFOCACHETEST_H
+#define RESOURCEINFOCACHETEST_H
+
+#include <common/test.h>
+
+class ResourceInfoCacheTest : public Test
+{
+    Q_OBJECT
+public:
+    ResourceInfoCacheTest(QObject *parent = nullptr);
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testExistingResources();
+    void testMissingResources();
+
+    void cleanupTestCase();
+};
+
+#endif /* RESOURCEINFOCACHETEST_H */
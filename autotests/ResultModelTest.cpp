@@ -0,0 +1,839 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "ResultModelTest.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QPersistentModelIndex>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <PlasmaActivities/Consumer>
+#include <PlasmaActivities/Controller>
+
+#include <cleaning.h>
+#include <query.h>
+#include <resultmodel.h>
+#include <resultwatcher.h>
+
+#include <common/database/Database.h>
+#include <common/database/schema/ResourcesDatabaseSchema.h>
+
+#include <algorithm>
+
+namespace KAStats = KActivities::Stats;
+
+ResultModelTest::ResultModelTest(QObject *parent)
+    : Test(parent)
+{
+}
+
+namespace
+{
+// The resources used by this agent are /rmt/file000 to /rmt/file229,
+// the lower the number, the higher the score. The titles are
+// numbered the other way round, Document 230 to Document 1
+const QString s_agent = QStringLiteral("ResultModelTest");
+constexpr int s_resourceCount = 230;
+
+QDir snapshotsDirectory()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/plasma-activities-stats"));
+}
+
+QString resourceName(int index)
+{
+    return QStringLiteral("/rmt/file%1").arg(index, 3, 10, QLatin1Char('0'));
+}
+
+QString resourceAt(const KAStats::ResultModel &model, int row)
+{
+    return model.data(model.index(row), KAStats::ResultModel::ResourceRole).toString();
+}
+
+QStringList resourcesOf(const KAStats::ResultModel &model)
+{
+    QStringList result;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        result << resourceAt(model, row);
+    }
+    return result;
+}
+
+void setScore(int index, int score, int lastUpdate)
+{
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    auto query = database->createQuery();
+    query.prepare(QStringLiteral("UPDATE ResourceScoreCache SET cachedScore = :score, lastUpdate = :lastUpdate WHERE targettedResource = :resource"));
+    query.bindValue(QStringLiteral(":score"), score);
+    query.bindValue(QStringLiteral(":lastUpdate"), lastUpdate);
+    query.bindValue(QStringLiteral(":resource"), resourceName(index));
+    query.exec();
+}
+
+void insertScore(int index)
+{
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    auto query = database->createQuery();
+    query.prepare(
+        QStringLiteral("INSERT INTO ResourceScoreCache (usedActivity, initiatingAgent, targettedResource, scoreType, cachedScore, firstUpdate, lastUpdate) "
+                       "VALUES ('activity1', :agent, :resource, 0, :score, :firstUpdate, :lastUpdate)"));
+    query.bindValue(QStringLiteral(":agent"), s_agent);
+    query.bindValue(QStringLiteral(":resource"), resourceName(index));
+    query.bindValue(QStringLiteral(":score"), 1000 - index);
+    query.bindValue(QStringLiteral(":firstUpdate"), 1421000000 + index);
+    query.bindValue(QStringLiteral(":lastUpdate"), 1421500000 - index);
+    query.exec();
+}
+
+void setTitle(int index, const QString &title)
+{
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    auto query = database->createQuery();
+    query.prepare(QStringLiteral("UPDATE ResourceInfo SET title = :title WHERE targettedResource = :resource"));
+    query.bindValue(QStringLiteral(":title"), title);
+    query.bindValue(QStringLiteral(":resource"), resourceName(index));
+    query.exec();
+}
+
+QString originalTitle(int index)
+{
+    return QStringLiteral("Document %1").arg(s_resourceCount - index);
+}
+
+void setInfo(const QString &resource, const QString &title, const QString &mimetype)
+{
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    auto query = database->createQuery();
+    query.prepare(
+        QStringLiteral("INSERT OR REPLACE INTO ResourceInfo (targettedResource, title, mimetype, autoTitle, autoMimetype) "
+                       "VALUES (:resource, :title, :mimetype, 1, 1)"));
+    query.bindValue(QStringLiteral(":resource"), resource);
+    query.bindValue(QStringLiteral(":title"), title);
+    query.bindValue(QStringLiteral(":mimetype"), mimetype);
+    query.exec();
+}
+
+void setMimetype(int index, const QString &mimetype)
+{
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    auto query = database->createQuery();
+    query.prepare(QStringLiteral("UPDATE ResourceInfo SET mimetype = :mimetype WHERE targettedResource = :resource"));
+    query.bindValue(QStringLiteral(":mimetype"), mimetype);
+    query.bindValue(QStringLiteral(":resource"), resourceName(index));
+    query.exec();
+}
+
+void setLinked(int index, const QStringList &activities)
+{
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    auto query = database->createQuery();
+    query.prepare(QStringLiteral("DELETE FROM ResourceLink WHERE targettedResource = :resource"));
+    query.bindValue(QStringLiteral(":resource"), resourceName(index));
+    query.exec();
+
+    query.prepare(
+        QStringLiteral("INSERT INTO ResourceLink (usedActivity, initiatingAgent, targettedResource) "
+                       "VALUES (:activity, :agent, :resource)"));
+    for (const auto &activity : activities) {
+        query.bindValue(QStringLiteral(":activity"), activity);
+        query.bindValue(QStringLiteral(":agent"), s_agent);
+        query.bindValue(QStringLiteral(":resource"), resourceName(index));
+        query.exec();
+    }
+}
+
+void removeScore(int index)
+{
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    auto query = database->createQuery();
+    query.prepare(QStringLiteral("DELETE FROM ResourceScoreCache WHERE targettedResource = :resource"));
+    query.bindValue(QStringLiteral(":resource"), resourceName(index));
+    query.exec();
+}
+}
+
+void ResultModelTest::testUpdateCoalescing()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    constexpr int linkCount = 10;
+    constexpr int updateInterval = 1000;
+
+    ResultModel model(LinkedResources | Agent::global() | Activity::any());
+    model.setUpdateInterval(updateInterval);
+    QCOMPARE(model.updateInterval(), updateInterval);
+    QCOMPARE(model.rowCount(), 0);
+
+    QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+
+    // The watcher sees the links as soon as they come
+    ResultWatcher watcher(LinkedResources | Agent::global() | Activity::any());
+    int linked = 0;
+    QObject::connect(&watcher, &ResultWatcher::resultLinked, this, [&linked](const QString &resource) {
+        if (resource.startsWith(QLatin1String("test://coalesce"))) {
+            ++linked;
+        }
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+
+    TEST_CHUNK(QStringLiteral("Linking many resources at once"))
+    {
+        for (int i = 0; i < linkCount; ++i) {
+            model.linkToActivity(QUrl(QStringLiteral("test://coalesce%1").arg(i)), Activity::current(), Agent::global());
+        }
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(linked == linkCount, 5000);
+
+        // The model is still collecting the updates
+        const bool arrivedTogether = timer.elapsed() < updateInterval;
+        if (arrivedTogether) {
+            QCOMPARE(model.rowCount(), 0);
+        }
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(model.rowCount() == linkCount, 2 * updateInterval);
+
+        // All of them are inserted with one signal
+        if (arrivedTogether) {
+            QCOMPARE(insertedSpy.count(), 1);
+        }
+    }
+
+    TEST_CHUNK(QStringLiteral("Unlinking them"))
+    {
+        for (int i = 0; i < linkCount; ++i) {
+            model.unlinkFromActivity(QUrl(QStringLiteral("test://coalesce%1").arg(i)), Activity::current(), Agent::global());
+        }
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(model.rowCount() == 0, 5000);
+    }
+}
+
+void ResultModelTest::testReloadChanged()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any());
+    QCOMPARE(model.rowCount(), 50);
+
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+
+    TEST_CHUNK(QStringLiteral("Merging the changed results"))
+    {
+        // The activity manager does not know about these changes,
+        // the model only sees them when it is told to reload
+        removeScore(3);
+        setScore(40, 2000, 1421600000);
+
+        // Deleting the stats of an activity that does not exist
+        // changes nothing, but invalidates the results
+        forgetRecentStats(Activity{QStringLiteral("ResultModelTest-nonexistent")}, 1, Hours);
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(resourceAt(model, 0) == resourceName(40), 5000);
+
+        const auto resources = resourcesOf(model);
+        QCOMPARE(resources.size(), 50);
+        QVERIFY(!resources.contains(resourceName(3)));
+
+        // The removed result is replaced by the next one from the database
+        QCOMPARE(resources.last(), resourceName(50));
+
+        // Only the removed result is removed, the others stay
+        QCOMPARE(resetSpy.count(), 0);
+        QCOMPARE(removedSpy.count(), 1);
+    }
+
+    insertScore(3);
+    setScore(40, 1000 - 40, 1421500000 - 40);
+}
+
+void ResultModelTest::testRoleScopedChanges()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any());
+    QCOMPARE(model.rowCount(), 50);
+
+    QList<QList<int>> changedRoles;
+    QObject::connect(&model, &QAbstractItemModel::dataChanged, this, [&](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        QCOMPARE(topLeft.row(), 2);
+        QCOMPARE(bottomRight.row(), 2);
+        changedRoles << roles;
+    });
+
+    TEST_CHUNK(QStringLiteral("Telling which roles have changed"))
+    {
+        // The watchers notice the changes to the database themselves
+        setTitle(2, QStringLiteral("Renamed document"));
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(changedRoles.size() == 1, 5000);
+
+        auto roles = changedRoles.first();
+        std::sort(roles.begin(), roles.end());
+        QCOMPARE(roles, (QList<int>{Qt::DisplayRole, ResultModel::TitleRole}));
+    }
+
+    TEST_CHUNK(QStringLiteral("Ignoring the changes that do not change anything"))
+    {
+        setTitle(2, QStringLiteral("Renamed document"));
+
+        QTest::qWait(1000);
+        QCOMPARE(changedRoles.size(), 1);
+    }
+
+    setTitle(2, originalTitle(2));
+    TEST_WAIT_UNTIL_WITH_TIMEOUT(changedRoles.size() == 2, 5000);
+}
+
+void ResultModelTest::testTitlePropagation()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any());
+    ResultModel otherModel(UsedResources | RecentlyUsedFirst | Agent{s_agent} | Activity::any());
+    QCOMPARE(model.rowCount(), 50);
+
+    const auto title = [](const ResultModel &model, int row) {
+        return model.data(model.index(row), ResultModel::TitleRole).toString();
+    };
+    const auto mimetype = [](const ResultModel &model, int row) {
+        return model.data(model.index(row), ResultModel::MimeType).toString();
+    };
+
+    TEST_CHUNK(QStringLiteral("Noticing the changed title"))
+    {
+        // Nobody tells the watchers about this change,
+        // they see it in the database
+        setTitle(7, QStringLiteral("Propagated title"));
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(title(model, 7) == QStringLiteral("Propagated title"), 5000);
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(title(otherModel, 7) == QStringLiteral("Propagated title"), 5000);
+    }
+
+    TEST_CHUNK(QStringLiteral("Noticing the changed mimetype"))
+    {
+        setMimetype(7, QStringLiteral("text/x-propagated"));
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(mimetype(model, 7) == QStringLiteral("text/x-propagated"), 5000);
+        QCOMPARE(title(model, 7), QStringLiteral("Propagated title"));
+    }
+
+    setTitle(7, originalTitle(7));
+    setMimetype(7, QStringLiteral("text/plain"));
+    TEST_WAIT_UNTIL_WITH_TIMEOUT(title(model, 7) == originalTitle(7) && mimetype(model, 7) == QStringLiteral("text/plain"), 5000);
+}
+
+void ResultModelTest::testDisplayString()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any());
+    QCOMPARE(model.rowCount(), 50);
+
+    const auto displayString = [&model](int row) {
+        const auto index = model.index(row);
+        return model.data(index, ResultModel::TitleRole).toString() + QStringLiteral(" ") + model.data(index, ResultModel::ResourceRole).toString()
+            + QStringLiteral(" - ") + QString::number(model.data(index, ResultModel::LinkStatusRole).toInt()) + QStringLiteral(" - ")
+            + QString::number(model.data(index, ResultModel::ScoreRole).toDouble());
+    };
+
+    TEST_CHUNK(QStringLiteral("Showing the title, resource, link status and score"))
+    {
+        for (const int row : {0, 1, 49}) {
+            QCOMPARE(model.data(model.index(row)).toString(), displayString(row));
+        }
+    }
+
+    TEST_CHUNK(QStringLiteral("Updating the string when the title changes"))
+    {
+        const auto previous = model.data(model.index(4)).toString();
+
+        setTitle(4, QStringLiteral("Renamed document"));
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(model.data(model.index(4), ResultModel::TitleRole).toString() == QStringLiteral("Renamed document"), 5000);
+
+        QVERIFY(model.data(model.index(4)).toString() != previous);
+        QCOMPARE(model.data(model.index(4)).toString(), displayString(4));
+    }
+
+    setTitle(4, originalTitle(4));
+    TEST_WAIT_UNTIL_WITH_TIMEOUT(model.data(model.index(4), ResultModel::TitleRole).toString() == originalTitle(4), 5000);
+}
+
+void ResultModelTest::testLinkedActivities()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    const QStringList activities{QStringLiteral("activity1"), QStringLiteral("activity2")};
+    setLinked(1, activities);
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any());
+    QCOMPARE(model.rowCount(), 50);
+
+    QSignalSpy changedSpy(&model, &QAbstractItemModel::dataChanged);
+
+    TEST_CHUNK(QStringLiteral("Loading the linked activities in the background"))
+    {
+        // Nothing is known until the activities are loaded
+        QCOMPARE(model.data(model.index(1), ResultModel::LinkedActivitiesRole).toStringList(), QStringList());
+
+        const auto linkedActivities = [&model] {
+            auto result = model.data(model.index(1), ResultModel::LinkedActivitiesRole).toStringList();
+            result.sort();
+            return result;
+        };
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(linkedActivities() == activities, 5000);
+
+        for (const auto &arguments : std::as_const(changedSpy)) {
+            QCOMPARE(arguments.at(2).value<QList<int>>(), QList<int>{ResultModel::LinkedActivitiesRole});
+        }
+    }
+
+    TEST_CHUNK(QStringLiteral("Loading the activities of the whole page at once"))
+    {
+        // The other results of the page were loaded along with the first one
+        changedSpy.clear();
+        QCOMPARE(model.data(model.index(2), ResultModel::LinkedActivitiesRole).toStringList(), QStringList());
+
+        QTest::qWait(500);
+        QCOMPARE(changedSpy.count(), 0);
+    }
+
+    setLinked(1, {});
+}
+
+void ResultModelTest::testTitleResolution()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    const QString resource = QStringLiteral("test://resolution1");
+    setInfo(resource, QStringLiteral("Resolved title"), QStringLiteral("text/x-resolved"));
+
+    ResultModel model(LinkedResources | Agent::global() | Activity::any());
+    QCOMPARE(model.rowCount(), 0);
+
+    TEST_CHUNK(QStringLiteral("Loading the title of a new result"))
+    {
+        model.linkToActivity(QUrl(resource), Activity::current(), Agent::global());
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(model.rowCount() == 1, 5000);
+
+        // The result is inserted before its title is known,
+        // which is then loaded in the background
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(model.data(model.index(0), ResultModel::TitleRole).toString() == QStringLiteral("Resolved title"), 5000);
+        QCOMPARE(model.data(model.index(0), ResultModel::MimeType).toString(), QStringLiteral("text/x-resolved"));
+    }
+
+    model.unlinkFromActivity(QUrl(resource), Activity::current(), Agent::global());
+    TEST_WAIT_UNTIL_WITH_TIMEOUT(model.rowCount() == 0, 5000);
+}
+
+void ResultModelTest::testPrefetch()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any() | Limit(1000));
+    QCOMPARE(model.rowCount(), 50);
+
+    QStringList expected;
+    for (int i = 0; i < s_resourceCount; ++i) {
+        expected << resourceName(i);
+    }
+
+    TEST_CHUNK(QStringLiteral("Fetching the pages that were loaded in the background"))
+    {
+        while (model.canFetchMore(QModelIndex())) {
+            const int previousCount = model.rowCount();
+
+            // Reading close to the end of the loaded results
+            // starts loading the next page in the background
+            QCOMPARE(resourceAt(model, previousCount - 5), resourceName(previousCount - 5));
+            QTest::qWait(100);
+
+            model.fetchMore(QModelIndex());
+            QVERIFY(model.rowCount() > previousCount);
+        }
+
+        QCOMPARE(resourcesOf(model), expected);
+    }
+}
+
+void ResultModelTest::testMemoryBudget()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any() | Limit(1000));
+    QCOMPARE(model.rowCount(), 50);
+    QCOMPARE(model.memoryBudget(), 0);
+
+    const auto footprint = model.memoryFootprint();
+    QVERIFY(footprint > 0);
+
+    TEST_CHUNK(QStringLiteral("Counting the fetched results"))
+    {
+        QVERIFY(model.canFetchMore(QModelIndex()));
+        model.fetchMore(QModelIndex());
+
+        QVERIFY(model.rowCount() > 50);
+        QVERIFY(model.memoryFootprint() > footprint);
+    }
+
+    TEST_CHUNK(QStringLiteral("Not fetching more when the budget is used up"))
+    {
+        model.setMemoryBudget(model.memoryFootprint());
+        QCOMPARE(model.memoryBudget(), model.memoryFootprint());
+        QVERIFY(!model.canFetchMore(QModelIndex()));
+
+        // Zero means that the memory use is not limited
+        model.setMemoryBudget(0);
+        QVERIFY(model.canFetchMore(QModelIndex()));
+    }
+}
+
+void ResultModelTest::testWindowed()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any() | Limit(1000), QString(), ResultModel::Windowed);
+
+    TEST_CHUNK(QStringLiteral("Knowing the number of results up front"))
+    {
+        QCOMPARE(model.rowCount(), s_resourceCount);
+        QVERIFY(!model.canFetchMore(QModelIndex()));
+
+        // The first page is loaded right away
+        QCOMPARE(resourceAt(model, 0), resourceName(0));
+    }
+
+    TEST_CHUNK(QStringLiteral("Loading the pages when they are needed"))
+    {
+        // Each page continues after the last result of the previous one
+        for (const int row : {60, 110, 160, s_resourceCount - 1}) {
+            TEST_WAIT_UNTIL_WITH_TIMEOUT(resourceAt(model, row) == resourceName(row), 2000);
+        }
+
+        for (int row = 100; row < 150; ++row) {
+            QCOMPARE(resourceAt(model, row), resourceName(row));
+        }
+    }
+
+    TEST_CHUNK(QStringLiteral("Keeping only the recently used pages"))
+    {
+        // The model always keeps at least one page
+        model.setMemoryBudget(1);
+        QCOMPARE(model.memoryBudget(), 1);
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(resourceAt(model, 0) == resourceName(0), 2000);
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(resourceAt(model, 200) == resourceName(200), 2000);
+
+        QVERIFY(model.memoryFootprint() > 0);
+
+        // The first page was evicted to make room for the last one
+        QVERIFY(!model.data(model.index(0), ResultModel::ResourceRole).isValid());
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(resourceAt(model, 0) == resourceName(0), 2000);
+    }
+}
+
+void ResultModelTest::testClientSort()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any() | Limit(1000));
+    QCOMPARE(model.rowCount(), 50);
+
+    const QPersistentModelIndex first(model.index(0));
+    const QPersistentModelIndex tenth(model.index(10));
+
+    QSignalSpy layoutSpy(&model, &QAbstractItemModel::layoutChanged);
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+    TEST_CHUNK(QStringLiteral("Sorting by the title"))
+    {
+        // The titles are numbered the other way round
+        model.sortItems(Qt::AscendingOrder, ResultModel::TitleRole);
+
+        QCOMPARE(layoutSpy.count(), 1);
+        QCOMPARE(resourceAt(model, 0), resourceName(49));
+
+        QCOMPARE(first.row(), 49);
+        QCOMPARE(first.data(ResultModel::ResourceRole).toString(), resourceName(0));
+        QCOMPARE(tenth.row(), 39);
+        QCOMPARE(tenth.data(ResultModel::ResourceRole).toString(), resourceName(10));
+    }
+
+    TEST_CHUNK(QStringLiteral("Going back to the query order"))
+    {
+        model.sortItems(Qt::AscendingOrder, -1);
+
+        QCOMPARE(layoutSpy.count(), 2);
+        QCOMPARE(resourceAt(model, 0), resourceName(0));
+        QCOMPARE(first.row(), 0);
+        QCOMPARE(tenth.row(), 10);
+    }
+
+    TEST_CHUNK(QStringLiteral("Sorting the results that are fetched later"))
+    {
+        model.sortItems(Qt::AscendingOrder, ResultModel::TitleRole);
+        model.fetchMore(QModelIndex());
+
+        QCOMPARE(model.rowCount(), 100);
+        QCOMPARE(resourceAt(model, 0), resourceName(99));
+        QCOMPARE(resourceAt(model, 99), resourceName(0));
+        QCOMPARE(first.row(), 99);
+    }
+
+    TEST_CHUNK(QStringLiteral("Sorting by the title without the role"))
+    {
+        // This sorts in memory, like the overload with the role
+        model.sortItems(Qt::DescendingOrder);
+
+        QCOMPARE(model.rowCount(), 100);
+        QCOMPARE(resourceAt(model, 0), resourceName(0));
+        QCOMPARE(resourceAt(model, 99), resourceName(99));
+        QCOMPARE(first.row(), 0);
+    }
+
+    QCOMPARE(resetSpy.count(), 0);
+}
+
+void ResultModelTest::testTitleOrder()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    // Byte by byte, Document 10 would come before Document 2
+    ResultModel model(UsedResources | OrderByTitle | Agent{s_agent} | Activity::any() | Limit(60));
+
+    TEST_CHUNK(QStringLiteral("Loading the first results in the collated order"))
+    {
+        QCOMPARE(model.rowCount(), 60);
+        QVERIFY(!model.canFetchMore(QModelIndex()));
+
+        for (int row = 0; row < 60; ++row) {
+            QCOMPARE(resourceAt(model, row), resourceName(s_resourceCount - 1 - row));
+        }
+    }
+}
+
+void ResultModelTest::testSnapshot()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    const auto query = UsedResources | HighScoredFirst | Agent{s_agent} | Activity::any();
+    const QString clientId = QStringLiteral("ResultModelTest");
+
+    TEST_CHUNK(QStringLiteral("Saving the results when the model is destroyed"))
+    {
+        {
+            ResultModel model(query, clientId, ResultModel::WarmStartSnapshot);
+            QCOMPARE(model.rowCount(), 50);
+        }
+
+        // The snapshot is written in the background
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(snapshotsDirectory().entryList({QStringLiteral("*.snapshot")}, QDir::Files).size() == 1, 2000);
+    }
+
+    TEST_CHUNK(QStringLiteral("Starting with the results from the snapshot"))
+    {
+        // The snapshot does not know about this
+        removeScore(0);
+
+        ResultModel model(query, clientId, ResultModel::WarmStartSnapshot);
+
+        QCOMPARE(model.rowCount(), 50);
+        QCOMPARE(resourceAt(model, 0), resourceName(0));
+        QCOMPARE(model.data(model.index(0), ResultModel::TitleRole).toString(), originalTitle(0));
+
+        // The results are replaced by the ones from the database in the background
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(resourceAt(model, 0) == resourceName(1), 2000);
+        QCOMPARE(model.rowCount(), 50);
+        QCOMPARE(resourceAt(model, 49), resourceName(50));
+    }
+
+    insertScore(0);
+}
+
+void ResultModelTest::testActivitySwitching()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    KActivities::Consumer kamd;
+
+    while (kamd.serviceStatus() == KActivities::Consumer::Unknown) {
+        QCoreApplication::processEvents();
+    }
+
+    const auto originalActivity = kamd.currentActivity();
+
+    QString otherActivity;
+    for (const auto &activity : kamd.runningActivities()) {
+        if (activity != originalActivity) {
+            otherActivity = activity;
+            break;
+        }
+    }
+
+    if (otherActivity.isEmpty()) {
+        QSKIP("Switching the activities needs at least two running activities");
+    }
+
+    // Each activity has its own results
+    const QString agent = QStringLiteral("ResultModelTest-activities");
+    {
+        auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+        auto query = database->createQuery();
+        query.prepare(
+            QStringLiteral("INSERT INTO ResourceScoreCache (usedActivity, initiatingAgent, targettedResource, scoreType, cachedScore, firstUpdate, lastUpdate) "
+                           "VALUES (:activity, :agent, :resource, 0, :score, 1421000000, 1421500000)"));
+
+        for (int i = 0; i < 3; ++i) {
+            for (const auto &activity : {originalActivity, otherActivity}) {
+                query.bindValue(QStringLiteral(":activity"), activity);
+                query.bindValue(QStringLiteral(":agent"), agent);
+                query.bindValue(QStringLiteral(":resource"), QStringLiteral("/rmt/%1/file%2").arg(activity).arg(i));
+                query.bindValue(QStringLiteral(":score"), 10 - i);
+                query.exec();
+            }
+        }
+    }
+
+    const auto isShowing = [](const ResultModel &model, const QString &activity) {
+        return model.rowCount() == 3 && resourceAt(model, 0) == QStringLiteral("/rmt/%1/file0").arg(activity);
+    };
+
+    ResultModel model(UsedResources | HighScoredFirst | Agent{agent} | Activity::current());
+    QVERIFY(isShowing(model, originalActivity));
+
+    // When the results are reset, the model is empty for a while
+    int leastRows = model.rowCount();
+    QObject::connect(&model, &QAbstractItemModel::rowsRemoved, this, [&] {
+        leastRows = qMin(leastRows, model.rowCount());
+    });
+
+    KActivities::Controller controller;
+
+    TEST_CHUNK(QStringLiteral("Switching to another activity"))
+    {
+        controller.setCurrentActivity(otherActivity);
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(isShowing(model, otherActivity), 5000);
+    }
+
+    TEST_CHUNK(QStringLiteral("Switching back to the activity the model has seen"))
+    {
+        leastRows = model.rowCount();
+
+        controller.setCurrentActivity(originalActivity);
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(isShowing(model, originalActivity), 5000);
+
+        // The results were kept, they replaced the ones
+        // from the other activity without emptying the model
+        QVERIFY(leastRows > 0);
+    }
+
+    TEST_WAIT_UNTIL_WITH_TIMEOUT(kamd.currentActivity() == originalActivity, 5000);
+}
+
+void ResultModelTest::initTestCase()
+{
+    // The snapshots of the models are saved with the other cached
+    // files, the test mode is enabled for all the tests in main
+    snapshotsDirectory().removeRecursively();
+
+    QTemporaryDir dir(QDir::tempPath() + QStringLiteral("/KActivitiesStatsTest_ResultModelTest_XXXXXX"));
+    dir.setAutoRemove(false);
+
+    if (!dir.isValid()) {
+        qFatal("Can not create a temporary directory");
+    }
+
+    const QString databaseFile = dir.path() + QStringLiteral("/database");
+
+    Common::ResourcesDatabaseSchema::overridePath(databaseFile);
+    qDebug() << "Creating database in " << databaseFile;
+
+    auto database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadWrite);
+
+    Common::ResourcesDatabaseSchema::initSchema(*database);
+
+    DATABASE_TRANSACTION(*database);
+
+    auto scoreQuery = database->createQuery();
+    scoreQuery.prepare(
+        QStringLiteral("INSERT INTO ResourceScoreCache (usedActivity, initiatingAgent, targettedResource, scoreType, cachedScore, firstUpdate, lastUpdate) "
+                       "VALUES ('activity1', :agent, :resource, 0, :score, :firstUpdate, :lastUpdate)"));
+
+    auto infoQuery = database->createQuery();
+    infoQuery.prepare(
+        QStringLiteral("INSERT INTO ResourceInfo (targettedResource, title, mimetype, autoTitle, autoMimetype) "
+                       "VALUES (:resource, :title, 'text/plain', 1, 1)"));
+
+    for (int i = 0; i < s_resourceCount; ++i) {
+        scoreQuery.bindValue(QStringLiteral(":agent"), s_agent);
+        scoreQuery.bindValue(QStringLiteral(":resource"), resourceName(i));
+        scoreQuery.bindValue(QStringLiteral(":score"), 1000 - i);
+        scoreQuery.bindValue(QStringLiteral(":firstUpdate"), 1421000000 + i);
+        scoreQuery.bindValue(QStringLiteral(":lastUpdate"), 1421500000 - i);
+        scoreQuery.exec();
+
+        infoQuery.bindValue(QStringLiteral(":resource"), resourceName(i));
+        infoQuery.bindValue(QStringLiteral(":title"), originalTitle(i));
+        infoQuery.exec();
+    }
+}
+
+void ResultModelTest::cleanupTestCase()
+{
+    Q_EMIT testFinished();
+}
+
+#include "moc_ResultModelTest.cpp"
@@ -0,0 +1,39 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RESULTMODELTEST_H
+#define RESULTMODELTEST_H
+
+#include <common/test.h>
+
+class ResultModelTest : public Test
+{
+    Q_OBJECT
+public:
+    ResultModelTest(QObject *parent = nullptr);
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testUpdateCoalescing();
+    void testReloadChanged();
+    void testRoleScopedChanges();
+    void testTitlePropagation();
+    void testDisplayString();
+    void testLinkedActivities();
+    void testTitleResolution();
+    void testPrefetch();
+    void testMemoryBudget();
+    void testWindowed();
+    void testClientSort();
+    void testTitleOrder();
+    void testSnapshot();
+    void testActivitySwitching();
+
+    void cleanupTestCase();
+};
+
+#endif /* RESULTMODELTEST_H */
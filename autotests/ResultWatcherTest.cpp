@@ -10,13 +10,19 @@
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
 #include <QString>
 #include <QTemporaryDir>
 #include <QTest>
+#include <QThread>
 #include <QTime>
+#include <QUrl>
 
 #include <PlasmaActivities/ResourceInstance>
 
+#include <cleaning.h>
 #include <query.h>
 #include <resultset.h>
 #include <resultwatcher.h>
@@ -24,6 +30,9 @@
 #include <common/database/Database.h>
 #include <common/database/schema/ResourcesDatabaseSchema.h>
 
+#include <memory>
+#include <vector>
+
 namespace KAStats = KActivities::Stats;
 
 ResultWatcherTest::ResultWatcherTest(QObject *parent)
@@ -80,6 +89,249 @@ void ResultWatcherTest::testLinkedResources()
     CHECK_SIGNAL_RESULT(&watcher, &KAStats::ResultWatcher::resultUnlinked, 5, (const QString &uri), QCOMPARE(QStringLiteral("test://link1"), uri));
 }
 
+void ResultWatcherTest::testOtherWatchersChanges()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    KAStats::ResultWatcher watcher(LinkedResources | Agent(QStringLiteral("org.kde.ResultWatcherTest.nothing")) | Activity::any());
+
+    QSignalSpy missedSpy(&watcher, &KAStats::ResultWatcher::changesMissed);
+    QSignalSpy invalidatedSpy(&watcher, &KAStats::ResultWatcher::resultsInvalidated);
+
+    // Creating another watcher, and changing the data it is
+    // interested in, should not bother the first one
+    KAStats::ResultWatcher otherWatcher(LinkedResources | Agent::global() | Activity::any());
+
+    otherWatcher.linkToActivity(QUrl(QStringLiteral("test://link2")), Activity::current());
+    CHECK_SIGNAL_RESULT(&otherWatcher, &KAStats::ResultWatcher::resultLinked, 5, (const QString &uri), QCOMPARE(QStringLiteral("test://link2"), uri));
+
+    otherWatcher.unlinkFromActivity(QUrl(QStringLiteral("test://link2")), Activity::current());
+    CHECK_SIGNAL_RESULT(&otherWatcher, &KAStats::ResultWatcher::resultUnlinked, 5, (const QString &uri), QCOMPARE(QStringLiteral("test://link2"), uri));
+
+    // Longer than the hub waits before checking for the missed changes
+    liveSleep(2);
+
+    QCOMPARE(missedSpy.count(), 0);
+    QCOMPARE(invalidatedSpy.count(), 0);
+}
+
+void ResultWatcherTest::testInvalidationDebouncing()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    constexpr int deletions = 10;
+
+    KAStats::ResultWatcher watcher(UsedResources | Agent::any() | Activity::any());
+
+    QSignalSpy invalidatedSpy(&watcher, &KAStats::ResultWatcher::resultsInvalidated);
+
+    // Deleting the stats of an activity that does not exist changes
+    // nothing, but the watchers are told to invalidate their results
+    const auto forgetNothing = [] {
+        forgetRecentStats(Activity{QStringLiteral("ResultWatcherTest-nonexistent")}, 1, Hours);
+    };
+
+    TEST_CHUNK(QStringLiteral("Invalidating the results right away after a quiet period"))
+    {
+        forgetNothing();
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(invalidatedSpy.count() == 1, 5000);
+
+        // A single event is not followed by a postponed invalidation
+        liveSleep(1);
+        QCOMPARE(invalidatedSpy.count(), 1);
+    }
+
+    TEST_CHUNK(QStringLiteral("Collecting the invalidations while they keep coming"))
+    {
+        invalidatedSpy.clear();
+
+        for (int i = 0; i < deletions; ++i) {
+            forgetNothing();
+        }
+
+        // The events that came after the first one are not lost,
+        // they are applied within the maximum latency
+        liveSleep(3);
+
+        QVERIFY(invalidatedSpy.count() >= 2);
+        QVERIFY(invalidatedSpy.count() < deletions);
+    }
+}
+
+void ResultWatcherTest::testSharedConnection()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    auto watcher = std::make_unique<KAStats::ResultWatcher>(LinkedResources | Agent::global() | Activity::any());
+    KAStats::ResultWatcher otherWatcher(LinkedResources | Agent::global() | Activity::any());
+
+    QSignalSpy linkedSpy(watcher.get(), &KAStats::ResultWatcher::resultLinked);
+
+    TEST_CHUNK(QStringLiteral("Notifying all the watchers"))
+    {
+        otherWatcher.linkToActivity(QUrl(QStringLiteral("test://shared1")), Activity::current());
+        CHECK_SIGNAL_RESULT(&otherWatcher, &KAStats::ResultWatcher::resultLinked, 5, (const QString &uri), QCOMPARE(QStringLiteral("test://shared1"), uri));
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(linkedSpy.count() == 1, 5000);
+        QCOMPARE(linkedSpy.first().first().toString(), QStringLiteral("test://shared1"));
+    }
+
+    TEST_CHUNK(QStringLiteral("Notifying the remaining watcher"))
+    {
+        // The connection to the activity manager is shared,
+        // it stays while there are watchers that use it
+        watcher.reset();
+
+        otherWatcher.unlinkFromActivity(QUrl(QStringLiteral("test://shared1")), Activity::current());
+        CHECK_SIGNAL_RESULT(&otherWatcher, &KAStats::ResultWatcher::resultUnlinked, 5, (const QString &uri), QCOMPARE(QStringLiteral("test://shared1"), uri));
+    }
+}
+
+void ResultWatcherTest::testIndexedListeners()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    const Agent agent{QStringLiteral("org.kde.ResultWatcherTest.linker")};
+
+    KAStats::ResultWatcher watcher(LinkedResources | agent | Activity::any());
+
+    // The hub only looks at the listeners for the agent and activity
+    // of the event, these should not be bothered
+    KAStats::ResultWatcher otherAgentWatcher(LinkedResources | Agent(QStringLiteral("org.kde.ResultWatcherTest.other")) | Activity::any());
+    KAStats::ResultWatcher otherActivityWatcher(LinkedResources | agent | Activity(QStringLiteral("ResultWatcherTest-nonexistent")));
+
+    QSignalSpy otherAgentLinkedSpy(&otherAgentWatcher, &KAStats::ResultWatcher::resultLinked);
+    QSignalSpy otherAgentUnlinkedSpy(&otherAgentWatcher, &KAStats::ResultWatcher::resultUnlinked);
+    QSignalSpy otherActivityLinkedSpy(&otherActivityWatcher, &KAStats::ResultWatcher::resultLinked);
+    QSignalSpy otherActivityUnlinkedSpy(&otherActivityWatcher, &KAStats::ResultWatcher::resultUnlinked);
+
+    watcher.linkToActivity(QUrl(QStringLiteral("test://indexed1")), Activity::current(), agent);
+    CHECK_SIGNAL_RESULT(&watcher, &KAStats::ResultWatcher::resultLinked, 5, (const QString &uri), QCOMPARE(QStringLiteral("test://indexed1"), uri));
+
+    watcher.unlinkFromActivity(QUrl(QStringLiteral("test://indexed1")), Activity::current(), agent);
+    CHECK_SIGNAL_RESULT(&watcher, &KAStats::ResultWatcher::resultUnlinked, 5, (const QString &uri), QCOMPARE(QStringLiteral("test://indexed1"), uri));
+
+    liveSleep(1);
+
+    QCOMPARE(otherAgentLinkedSpy.count(), 0);
+    QCOMPARE(otherAgentUnlinkedSpy.count(), 0);
+    QCOMPARE(otherActivityLinkedSpy.count(), 0);
+    QCOMPARE(otherActivityUnlinkedSpy.count(), 0);
+}
+
+void ResultWatcherTest::testScoreRules()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    const QString agent = QStringLiteral("org.kde.ResultWatcherTest.scores");
+
+    QTemporaryDir dir(QDir::tempPath() + QStringLiteral("/KActivitiesStatsTest_ResultWatcherTest_XXXXXX"));
+    QVERIFY(dir.isValid());
+
+    QFile file(dir.filePath(QStringLiteral("scored.txt")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    const auto url = QUrl::fromLocalFile(file.fileName());
+
+    // Both watchers use the same rule for the score updates on the bus,
+    // it needs to stay while one of them is still there
+    auto watcher = std::make_unique<KAStats::ResultWatcher>(UsedResources | Agent{agent} | Activity::current());
+    KAStats::ResultWatcher otherWatcher(UsedResources | Agent{agent} | Activity::current());
+
+    watcher.reset();
+
+    KActivities::ResourceInstance::notifyAccessed(url, agent);
+
+    CHECK_SIGNAL_RESULT(&otherWatcher, &KAStats::ResultWatcher::resultScoreUpdated, 10, (const QString &resource, double, uint, uint),
+                        QCOMPARE(resource, url.toLocalFile()));
+}
+
+void ResultWatcherTest::testDestructionDuringSignals()
+{
+    using namespace KAStats;
+    using namespace KAStats::Terms;
+
+    if (!isActivityManagerRunning()) {
+        QSKIP("The activity manager is not running");
+    }
+
+    constexpr int linkCount = 20;
+
+    KAStats::ResultWatcher watcher(LinkedResources | Agent::global() | Activity::any());
+
+    int linked = 0;
+    int unlinked = 0;
+    bool inMainThread = true;
+
+    QObject::connect(&watcher, &KAStats::ResultWatcher::resultLinked, this, [&](const QString &resource) {
+        if (resource.startsWith(QLatin1String("test://storm"))) {
+            inMainThread = inMainThread && QThread::currentThread() == QCoreApplication::instance()->thread();
+            ++linked;
+        }
+    });
+    QObject::connect(&watcher, &KAStats::ResultWatcher::resultUnlinked, this, [&](const QString &resource) {
+        if (resource.startsWith(QLatin1String("test://storm"))) {
+            inMainThread = inMainThread && QThread::currentThread() == QCoreApplication::instance()->thread();
+            ++unlinked;
+        }
+    });
+
+    // The watchers that come and go while the hub is calling them
+    std::vector<std::unique_ptr<KAStats::ResultWatcher>> watchers;
+
+    const auto churn = [&] {
+        watchers.clear();
+        for (int i = 0; i < 5; ++i) {
+            watchers.push_back(std::make_unique<KAStats::ResultWatcher>(LinkedResources | Agent::global() | Activity::any()));
+        }
+        QCoreApplication::processEvents();
+    };
+
+    TEST_CHUNK(QStringLiteral("Linking while the watchers are destroyed"))
+    {
+        for (int i = 0; i < linkCount; ++i) {
+            watcher.linkToActivity(QUrl(QStringLiteral("test://storm%1").arg(i)), Activity::current(), Agent::global());
+            churn();
+        }
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(linked == linkCount, 10000);
+    }
+
+    TEST_CHUNK(QStringLiteral("Unlinking while the watchers are destroyed"))
+    {
+        for (int i = 0; i < linkCount; ++i) {
+            watcher.unlinkFromActivity(QUrl(QStringLiteral("test://storm%1").arg(i)), Activity::current(), Agent::global());
+            churn();
+        }
+
+        TEST_WAIT_UNTIL_WITH_TIMEOUT(unlinked == linkCount, 10000);
+    }
+
+    watchers.clear();
+
+    // The signals are delivered in the thread the watcher belongs to
+    QVERIFY(inMainThread);
+}
+
 void ResultWatcherTest::initTestCase()
 {
 }
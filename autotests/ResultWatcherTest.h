@@ -22,6 +22,12 @@ private Q_SLOTS:
     void initTestCase();
 
     void testLinkedResources();
+    void testOtherWatchersChanges();
+    void testInvalidationDebouncing();
+    void testSharedConnection();
+    void testIndexedListeners();
+    void testScoreRules();
+    void testDestructionDuringSignals();
 
     void cleanupTestCase();
 };
@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "StarPatternTest.h"
+
+#include <QString>
+#include <QTest>
+
+#include <common/database/Database.h>
+
+StarPatternTest::StarPatternTest(QObject *parent)
+    : Test(parent)
+{
+}
+
+void StarPatternTest::initTestCase()
+{
+}
+
+void StarPatternTest::testLikePattern()
+{
+    TEST_CHUNK(QStringLiteral("Converting star patterns to sql like patterns"))
+
+    using Common::starPatternToLike;
+
+    QCOMPARE(starPatternToLike(QStringLiteral("/home/*")), QStringLiteral("/home/%"));
+    QCOMPARE(starPatternToLike(QStringLiteral("*.txt")), QStringLiteral("%.txt"));
+    QCOMPARE(starPatternToLike(QStringLiteral("*50%_off*")), QStringLiteral("%50\\%\\_off%"));
+    QCOMPARE(starPatternToLike(QStringLiteral("a\\*b*")), QStringLiteral("a\\*b%"));
+    QCOMPARE(starPatternToLike(QStringLiteral("**")), QStringLiteral("%%"));
+    QCOMPARE(starPatternToLike(QString()), QString());
+}
+
+void StarPatternTest::testMatching_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<bool>("matches");
+
+    QTest::newRow("any") << QStringLiteral("*") << QStringLiteral("smb://server/file") << true;
+    QTest::newRow("any, empty") << QStringLiteral("**") << QString() << true;
+
+    QTest::newRow("exact") << QStringLiteral("/home/user") << QStringLiteral("/home/user") << true;
+    QTest::newRow("exact, longer") << QStringLiteral("/home/user") << QStringLiteral("/home/user/file") << false;
+
+    QTest::newRow("prefix") << QStringLiteral("smb:*") << QStringLiteral("smb://server/file") << true;
+    QTest::newRow("prefix, no match") << QStringLiteral("smb:*") << QStringLiteral("/smb:") << false;
+
+    QTest::newRow("suffix") << QStringLiteral("*.txt") << QStringLiteral("/home/notes.txt") << true;
+    QTest::newRow("suffix, no match") << QStringLiteral("*.txt") << QStringLiteral("/home/notes.txt~") << false;
+
+    QTest::newRow("contains") << QStringLiteral("*/Documents/*") << QStringLiteral("/home/user/Documents/file") << true;
+    QTest::newRow("contains, no match") << QStringLiteral("*/Documents/*") << QStringLiteral("/home/user/Documents") << false;
+
+    QTest::newRow("general") << QStringLiteral("/home/*/Documents/*.odt") << QStringLiteral("/home/user/Documents/report.odt") << true;
+    QTest::newRow("general, wrong suffix") << QStringLiteral("/home/*/Documents/*.odt") << QStringLiteral("/home/user/Documents/report.ods") << false;
+    QTest::newRow("general, overlapping") << QStringLiteral("a*a") << QStringLiteral("a") << false;
+    QTest::newRow("general, parts in order") << QStringLiteral("*b*a*") << QStringLiteral("abc") << false;
+    QTest::newRow("general, part in the suffix") << QStringLiteral("x*ab*b") << QStringLiteral("xab") << false;
+
+    QTest::newRow("escaped star") << QStringLiteral("a\\*b") << QStringLiteral("a*b") << true;
+    QTest::newRow("escaped star, not a joker") << QStringLiteral("a\\*b") << QStringLiteral("axb") << false;
+    QTest::newRow("escaped backslash") << QStringLiteral("a\\\\*") << QStringLiteral("a\\b") << true;
+
+    // Like the LIKE clause, only the ASCII letters ignore the case
+    QTest::newRow("case, exact") << QStringLiteral("/Home/User") << QStringLiteral("/home/USER") << true;
+    QTest::newRow("case, prefix") << QStringLiteral("SMB:*") << QStringLiteral("smb://server/file") << true;
+    QTest::newRow("case, suffix") << QStringLiteral("*.TXT") << QStringLiteral("/home/notes.txt") << true;
+    QTest::newRow("case, contains") << QStringLiteral("*/documents/*") << QStringLiteral("/home/user/Documents/file") << true;
+    QTest::newRow("case, general") << QStringLiteral("/HOME/*/documents/*.ODT") << QStringLiteral("/home/user/Documents/report.odt") << true;
+    QTest::newRow("case, not ascii") << QStringLiteral("*/\u00C4*") << QStringLiteral("/\u00E4") << false;
+}
+
+void StarPatternTest::testMatching()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QString, string);
+    QFETCH(bool, matches);
+
+    QCOMPARE(Common::StarPatternMatcher(pattern).matches(string), matches);
+}
+
+void StarPatternTest::cleanupTestCase()
+{
+    Q_EMIT testFinished();
+}
+
+#include "moc_StarPatternTest.cpp"
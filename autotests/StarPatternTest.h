@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef STARPATTERNTEST_H
+#define STARPATTERNTEST_H
+
+#include <common/test.h>
+
+class StarPatternTest : public Test
+{
+    Q_OBJECT
+public:
+    StarPatternTest(QObject *parent = nullptr);
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testLikePattern();
+    void testMatching_data();
+    void testMatching();
+
+    void cleanupTestCase();
+};
+
+#endif /* STARPATTERNTEST_H */
@@ -6,14 +6,21 @@
 
 #include <QCoreApplication>
 #include <QList>
+#include <QStandardPaths>
 #include <QTest>
 
 #include <common/test.h>
 
+#include "ActivitiesSyncTest.h"
+#include "ExistenceCheckerTest.h"
+#include "OrderingConfigWriterTest.h"
 #include "QueryTest.h"
+#include "ResourceInfoCacheTest.h"
+#include "ResultModelTest.h"
 #include "ResultSetQuickCheckTest.h"
 #include "ResultSetTest.h"
 #include "ResultWatcherTest.h"
+#include "StarPatternTest.h"
 
 class TestRunner : public QObject
 {
@@ -76,6 +83,10 @@ int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
 
+    // The tests must not touch the user's cached and configuration files,
+    // like the snapshots of the models and the saved ordering of the results
+    QStandardPaths::setTestModeEnabled(true);
+
     TestRunner &runner = *(new TestRunner());
 
     qDebug() << app.arguments();
@@ -91,7 +102,13 @@ int main(int argc, char *argv[])
     ADD_TEST(Query)
     ADD_TEST(ResultSet)
     ADD_TEST(ResultSetQuickCheck)
+    ADD_TEST(ResultModel)
     ADD_TEST(ResultWatcher)
+    ADD_TEST(StarPattern)
+    ADD_TEST(ExistenceChecker)
+    ADD_TEST(OrderingConfigWriter)
+    ADD_TEST(ResourceInfoCache)
+    ADD_TEST(ActivitiesSync)
 
     runner.start();
 
@@ -7,45 +7,230 @@
 #include "activitiessync_p.h"
 
 #include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusReply>
+#include <QList>
+#include <QPointer>
+#include <QThread>
+
+#include <PlasmaActivities/Consumer>
+
+#include <mutex>
+#include <utility>
+
+#include "common/dbus/common.h"
 
 namespace ActivitiesSync
 {
-typedef std::shared_ptr<KActivities::Consumer> ConsumerPtr;
+namespace
+{
+// How long we are prepared to block waiting for the activity manager
+// when the current activity is needed before the consumer knows it
+constexpr int s_fallbackTimeout = 500;
+
+struct ReadyCallback {
+    QPointer<QObject> context;
+    std::function<void()> callback;
+};
 
-ConsumerPtr instance()
+struct ChangeCallback {
+    QPointer<QObject> context;
+    std::function<void(const QString &)> callback;
+};
+
+std::mutex s_mutex;
+QString s_currentActivity;
+bool s_ready = false;
+bool s_fallbackTried = false;
+// Whether someone got the empty value before the activity was known
+bool s_unknownHandedOut = false;
+bool s_trackerRequested = false;
+QList<ReadyCallback> s_readyCallbacks;
+QList<ChangeCallback> s_changeCallbacks;
+
+KActivities::Consumer *s_consumer = nullptr;
+
+void notify(const QList<ReadyCallback> &callbacks)
 {
-    static std::mutex s_instanceMutex;
-    static std::weak_ptr<KActivities::Consumer> s_instance;
+    for (const auto &callback : callbacks) {
+        if (callback.context) {
+            QMetaObject::invokeMethod(callback.context.data(), callback.callback, Qt::QueuedConnection);
+        }
+    }
+}
+
+void setCurrentActivity(const QString &activity)
+{
+    QList<ReadyCallback> callbacks;
+    QList<ChangeCallback> changeCallbacks;
 
-    std::unique_lock<std::mutex> locker{s_instanceMutex};
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
 
-    auto ptr = s_instance.lock();
+        // Becoming ready is not a change, whenReady is for that,
+        // unless someone already used the empty value it had before
+        if ((s_ready || s_unknownHandedOut) && s_currentActivity != activity) {
+            s_changeCallbacks.removeIf([](const ChangeCallback &callback) {
+                return !callback.context;
+            });
+            changeCallbacks = s_changeCallbacks;
+        }
 
-    if (!ptr) {
-        ptr = std::make_shared<KActivities::Consumer>();
-        s_instance = ptr;
+        s_currentActivity = activity;
+        s_ready = true;
+        callbacks = std::exchange(s_readyCallbacks, {});
     }
 
-    return ptr;
+    notify(callbacks);
+
+    for (const auto &callback : std::as_const(changeCallbacks)) {
+        if (callback.context) {
+            QMetaObject::invokeMethod(
+                callback.context.data(),
+                [callback = callback.callback, activity] {
+                    callback(activity);
+                },
+                Qt::AutoConnection);
+        }
+    }
 }
 
-QString currentActivity(ConsumerPtr &activities)
+void update()
 {
-    // We need to get the current activity synchonously,
-    // this means waiting for the service to be available.
-    // It should not introduce blockages since there usually
-    // is a global activity cache in applications that care
-    // about activities.
+    if (!s_consumer || s_consumer->serviceStatus() == KActivities::Consumer::Unknown) {
+        return;
+    }
+
+    setCurrentActivity(s_consumer->currentActivity());
+}
 
-    if (!activities) {
-        activities = instance();
+void cleanup()
+{
+    delete std::exchange(s_consumer, nullptr);
+}
+
+void createConsumer()
+{
+    s_consumer = new KActivities::Consumer();
+
+    QObject::connect(s_consumer, &KActivities::Consumer::serviceStatusChanged, s_consumer, update);
+    QObject::connect(s_consumer, &KActivities::Consumer::currentActivityChanged, s_consumer, update);
+
+    qAddPostRoutine(cleanup);
+
+    update();
+}
+
+// The consumer needs to live in the main thread, we do not
+// want it to depend on the lifetime of some other thread
+void requestConsumer()
+{
+    const auto app = QCoreApplication::instance();
+
+    if (!app) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        if (std::exchange(s_trackerRequested, true)) {
+            return;
+        }
     }
 
-    while (activities->serviceStatus() == KActivities::Consumer::Unknown) {
-        QCoreApplication::instance()->processEvents();
+    if (QThread::currentThread() == app->thread()) {
+        createConsumer();
+    } else {
+        QMetaObject::invokeMethod(app, createConsumer, Qt::QueuedConnection);
     }
+}
+
+} // namespace
+
+QString currentActivity()
+{
+    requestConsumer();
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        // If the activity manager did not reply once, we are not
+        // blocking again, the consumer will tell us when it starts
+        if (s_ready) {
+            return s_currentActivity;
+        }
+
+        if (std::exchange(s_fallbackTried, true)) {
+            s_unknownHandedOut = true;
+            return s_currentActivity;
+        }
+    }
+
+    // The consumer does not know the current activity yet,
+    // we are asking the activity manager ourselves. Blocking
+    // here does not process the events, unlike the consumer would
+    const auto message = QDBusMessage::createMethodCall(KAMD_DBUS_SERVICE,
+                                                        QStringLiteral("/ActivityManager/Activities"),
+                                                        QStringLiteral("org.kde.ActivityManager.Activities"),
+                                                        QStringLiteral("CurrentActivity"));
+
+    const QDBusReply<QString> reply = QDBusConnection::sessionBus().call(message, QDBus::Block, s_fallbackTimeout);
+
+    if (!reply.isValid()) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        // The consumer might have set it in the meantime
+        if (!s_ready) {
+            s_unknownHandedOut = true;
+        }
+
+        return s_currentActivity;
+    }
+
+    // The consumer will keep the value up to date from now on
+    setCurrentActivity(reply.value());
+
+    return reply.value();
+}
+
+QString cachedCurrentActivity()
+{
+    requestConsumer();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (!s_ready) {
+        s_unknownHandedOut = true;
+    }
+
+    return s_currentActivity;
+}
+
+void whenReady(QObject *context, std::function<void()> callback)
+{
+    requestConsumer();
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        if (!s_ready) {
+            s_readyCallbacks << ReadyCallback{context, std::move(callback)};
+            return;
+        }
+    }
+
+    notify({ReadyCallback{context, std::move(callback)}});
+}
+
+void onCurrentActivityChanged(QObject *context, std::function<void(const QString &)> callback)
+{
+    requestConsumer();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
 
-    return activities->currentActivity();
+    s_changeCallbacks << ChangeCallback{context, std::move(callback)};
 }
 
 } // namespace ActivitiesSync
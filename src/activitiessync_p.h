@@ -7,16 +7,49 @@
 #ifndef ACTIVITIES_SYNC_P_H
 #define ACTIVITIES_SYNC_P_H
 
-#include <memory>
-#include <mutex>
+#include <QObject>
+#include <QString>
 
-#include <PlasmaActivities/Consumer>
+#include <functional>
 
 namespace ActivitiesSync
 {
-typedef std::shared_ptr<KActivities::Consumer> ConsumerPtr;
-
-QString currentActivity(ConsumerPtr &activities);
+/**
+ * Returns the current activity. It is cached, and kept up to date
+ * by a KActivities::Consumer that lives in the main thread.
+ *
+ * Until the consumer knows the current activity, it is requested
+ * from the activity manager directly, waiting for a limited time
+ * and without processing the events. This is only tried once,
+ * if it fails, the result is an empty string.
+ *
+ * This can be called from any thread.
+ */
+QString currentActivity();
+
+/**
+ * Returns the current activity if it is already known, and an empty
+ * string otherwise. Unlike currentActivity, this never blocks.
+ *
+ * This can be called from any thread.
+ */
+QString cachedCurrentActivity();
+
+/**
+ * Calls the callback in the thread of the context object when
+ * the current activity becomes known, or soon if it already is.
+ * The callback is not called if the context object is destroyed.
+ */
+void whenReady(QObject *context, std::function<void()> callback);
+
+/**
+ * Calls the callback in the thread of the context object every time
+ * the current activity changes, with the new current activity,
+ * until the context object is destroyed. If an empty string was
+ * returned before the current activity was known, it becoming
+ * known counts as a change as well.
+ */
+void onCurrentActivityChanged(QObject *context, std::function<void(const QString &)> callback);
 
 } // namespace ActivitiesSync
 
@@ -238,6 +238,11 @@ QVariant Database::pragma(const QString &pragma) const
     return value(QStringLiteral("PRAGMA ") + pragma);
 }
 
+qint64 Database::dataVersion() const
+{
+    return pragma(QStringLiteral("data_version")).toLongLong();
+}
+
 QVariant Database::value(const QString &query) const
 {
     auto result = execQuery(query);
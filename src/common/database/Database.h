@@ -7,8 +7,9 @@
 #ifndef COMMON_DATABASE_H
 #define COMMON_DATABASE_H
 
-#include <QRegularExpression>
 #include <QSqlQuery>
+#include <QStringList>
+#include <QStringView>
 #include <memory>
 
 namespace Common
@@ -37,6 +38,10 @@ public:
     QVariant pragma(const QString &pragma) const;
     QVariant value(const QString &query) const;
 
+    // Changes whenever another connection commits a change
+    // to the database, see PRAGMA data_version
+    qint64 dataVersion() const;
+
     ~Database();
     Database();
 
@@ -60,52 +65,71 @@ private:
     std::unique_ptr<Private> d;
 };
 
-template<typename EscapeFunction>
-QString parseStarPattern(const QString &pattern, const QString &joker, EscapeFunction escape)
+// SQLite limits the number of parameters in a query, the older versions
+// to 999 of them. This splits the values into batches that fit, and passes
+// each batch to the callback, along with the placeholders for an IN clause
+template<typename BatchFunction>
+void forEachParameterBatch(const QStringList &values, BatchFunction function)
 {
-    const auto begin = pattern.constBegin();
-    const auto end = pattern.constEnd();
+    constexpr qsizetype maxBatchSize = 500;
 
-    auto currentStart = pattern.constBegin();
-    auto currentPosition = pattern.constBegin();
+    for (qsizetype from = 0; from < values.size(); from += maxBatchSize) {
+        const auto batch = values.mid(from, maxBatchSize);
 
-    bool isEscaped = false;
+        QStringList placeholders;
+        placeholders.fill(QStringLiteral("?"), batch.size());
 
-    // This should be available in the QString class...
-    auto stringFromIterators = [&](const QString::const_iterator &currentStart, const QString::const_iterator &currentPosition) {
-        return pattern.mid(std::distance(begin, currentStart), std::distance(currentStart, currentPosition));
-    };
+        function(batch, placeholders.join(QLatin1Char(',')));
+    }
+}
 
-    // Escaping % and _ for sql like
-    // auto escape = [] (QString str) {
-    //     return str.replace("%", "\\%").replace("_", "\\_");
-    // };
+// Splits the pattern at the stars that are not escaped with a backslash,
+// and passes the parts to the callback. The escapes are left in the parts.
+// There is always one part more than there are stars, the parts can be empty
+template<typename PartFunction>
+void tokenizeStarPattern(const QString &pattern, PartFunction part)
+{
+    bool isEscaped = false;
+    qsizetype partStart = 0;
 
-    QString resultPattern;
-    resultPattern.reserve(pattern.size() * 1.5);
+    for (qsizetype position = 0; position < pattern.size(); ++position) {
+        const QChar current = pattern[position];
 
-    for (; currentPosition != end; ++currentPosition) {
         if (isEscaped) {
             // Just skip the current character
             isEscaped = false;
 
-        } else if (*currentPosition == QLatin1Char('\\')) {
+        } else if (current == QLatin1Char('\\')) {
             // Skip two characters
             isEscaped = true;
 
-        } else if (*currentPosition == QLatin1Char('*')) {
-            // Replacing the star with the sql like joker - %
-            resultPattern.append(escape(stringFromIterators(currentStart, currentPosition)) + joker);
-            currentStart = currentPosition + 1;
-
-        } else {
-            // This one is boring, nothing to do
+        } else if (current == QLatin1Char('*')) {
+            part(QStringView(pattern).mid(partStart, position - partStart));
+            partStart = position + 1;
         }
     }
 
-    if (currentStart != currentPosition) {
-        resultPattern.append(escape(stringFromIterators(currentStart, currentPosition)));
-    }
+    part(QStringView(pattern).mid(partStart));
+}
+
+template<typename EscapeFunction>
+QString parseStarPattern(const QString &pattern, const QString &joker, EscapeFunction escape)
+{
+    QString resultPattern;
+    resultPattern.reserve(pattern.size() * 1.5);
+
+    bool first = true;
+
+    tokenizeStarPattern(pattern, [&](QStringView part) {
+        if (!first) {
+            resultPattern.append(joker);
+        }
+        first = false;
+
+        if (!part.isEmpty()) {
+            resultPattern.append(escape(part.toString()));
+        }
+    });
 
     return resultPattern;
 }
@@ -120,11 +144,167 @@ inline QString starPatternToLike(const QString &pattern)
     return parseStarPattern(pattern, QStringLiteral("%"), escapeSqliteLikePattern);
 }
 
-inline QRegularExpression starPatternToRegex(const QString &pattern)
+/**
+ * Matches strings against a star pattern, the same way the LIKE clause
+ * created by starPatternToLike does. Like SQLite's LIKE, the ASCII letters
+ * are compared case-insensitively, and the other characters exactly.
+ * The common patterns (exact strings, prefixes, suffixes and substrings)
+ * are matched without any allocations.
+ */
+class StarPatternMatcher
 {
-    const QString parsed = parseStarPattern(pattern, QStringLiteral(".*"), QOverload<const QString &>::of(&QRegularExpression::escape));
-    return QRegularExpression(QRegularExpression::anchoredPattern(parsed));
-}
+public:
+    explicit StarPatternMatcher(const QString &pattern)
+    {
+        tokenizeStarPattern(pattern, [this](QStringView part) {
+            m_parts << unescaped(part);
+        });
+
+        const auto &first = m_parts.constFirst();
+        const auto &last = m_parts.constLast();
+
+        if (m_parts.size() == 1) {
+            m_kind = Exact;
+
+        } else if (m_parts.size() == 2 && last.isEmpty()) {
+            m_kind = first.isEmpty() ? Any : Prefix;
+
+        } else if (m_parts.size() == 2 && first.isEmpty()) {
+            m_kind = Suffix;
+
+        } else if (m_parts.size() == 3 && first.isEmpty() && last.isEmpty()) {
+            m_kind = m_parts[1].isEmpty() ? Any : Contains;
+
+        } else {
+            m_kind = General;
+        }
+    }
+
+    bool matches(QStringView string) const
+    {
+        switch (m_kind) {
+        case Any:
+            return true;
+
+        case Exact:
+            return equals(string, m_parts[0]);
+
+        case Prefix:
+            return startsWith(string, m_parts[0]);
+
+        case Suffix:
+            return endsWith(string, m_parts[1]);
+
+        case Contains:
+            return indexOf(string, m_parts[1], 0) != -1;
+
+        case General:
+            break;
+        }
+
+        const auto &first = m_parts.constFirst();
+        const auto &last = m_parts.constLast();
+
+        if (string.size() < first.size() + last.size() || !startsWith(string, first) || !endsWith(string, last)) {
+            return false;
+        }
+
+        // The parts between the stars need to be found in order,
+        // between the prefix and the suffix. Taking the leftmost
+        // occurrence of each part is always the right choice
+        qsizetype position = first.size();
+        const qsizetype limit = string.size() - last.size();
+
+        for (qsizetype i = 1; i < m_parts.size() - 1; ++i) {
+            const auto &part = m_parts[i];
+
+            const auto found = indexOf(string.first(limit), part, position);
+
+            if (found == -1) {
+                return false;
+            }
+
+            position = found + part.size();
+        }
+
+        return true;
+    }
+
+private:
+    static char16_t asciiLower(QChar character)
+    {
+        const char16_t unicode = character.unicode();
+        return unicode >= u'A' && unicode <= u'Z' ? unicode + (u'a' - u'A') : unicode;
+    }
+
+    static bool equals(QStringView left, QStringView right)
+    {
+        if (left.size() != right.size()) {
+            return false;
+        }
+
+        for (qsizetype i = 0; i < left.size(); ++i) {
+            if (asciiLower(left[i]) != asciiLower(right[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool startsWith(QStringView string, QStringView part)
+    {
+        return string.size() >= part.size() && equals(string.first(part.size()), part);
+    }
+
+    static bool endsWith(QStringView string, QStringView part)
+    {
+        return string.size() >= part.size() && equals(string.last(part.size()), part);
+    }
+
+    static qsizetype indexOf(QStringView string, QStringView part, qsizetype from)
+    {
+        for (qsizetype position = from; position + part.size() <= string.size(); ++position) {
+            if (equals(string.sliced(position, part.size()), part)) {
+                return position;
+            }
+        }
+
+        return -1;
+    }
+
+    static QString unescaped(QStringView part)
+    {
+        QString result;
+        result.reserve(part.size());
+
+        bool isEscaped = false;
+
+        for (const QChar current : part) {
+            if (!isEscaped && current == QLatin1Char('\\')) {
+                isEscaped = true;
+                continue;
+            }
+
+            isEscaped = false;
+            result.append(current);
+        }
+
+        return result;
+    }
+
+    enum Kind {
+        Any,
+        Exact,
+        Prefix,
+        Suffix,
+        Contains,
+        General,
+    };
+
+    Kind m_kind;
+    QStringList m_parts;
+};
 
 } // namespace Common
 
@@ -0,0 +1,350 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "existencechecker_p.h"
+
+// Qt
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QPromise>
+#include <QThreadPool>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// POSIX
+#include <cerrno>
+#include <sys/stat.h>
+
+#include "plasma-activities-stats-logsettings.h"
+#include "workerthread_p.h"
+
+namespace ExistenceChecker
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// A single check on a remote mount should not take longer than this,
+// otherwise we consider the mount to be slow and leave it alone for a while
+constexpr auto s_slowCheckThreshold = std::chrono::milliseconds(250);
+constexpr auto s_slowMountBackoff = std::chrono::minutes(10);
+
+// How much time we are prepared to spend on a single remote mount
+// in one pass over the resources
+constexpr auto s_mountTimeBudget = std::chrono::milliseconds(1000);
+
+// The mount table is cheap to read, but there is no need to do it
+// for every batch of resources
+constexpr auto s_mountTableLifetime = std::chrono::seconds(60);
+
+// How many remote mounts can be checked at the same time. This is also
+// how many threads can get stuck on stale mounts at most
+constexpr int s_maxRemoteChecks = 2;
+
+struct Mount {
+    QString path;
+    bool isRemote;
+};
+
+typedef std::shared_ptr<const std::vector<Mount>> Mounts;
+
+struct MountState {
+    bool checkInProgress = false;
+    Clock::time_point skipUntil;
+};
+
+std::mutex s_mutex;
+QHash<QString, MountState> s_mountStates;
+
+} // namespace
+
+namespace details
+{
+bool isRemoteFileSystem(const QByteArray &type)
+{
+    static const QByteArrayList remoteTypes{
+        "nfs", "nfs4", "cifs", "smb3", "smbfs", "ncpfs", "afs", "9p", "ceph", "glusterfs", "lustre", "davfs", "sshfs", "fuse",
+    };
+
+    // fuseblk is backed by a block device (ntfs-3g, exfat) and is local,
+    // other FUSE filesystems (sshfs, gvfsd-fuse, rclone...) are not
+    return remoteTypes.contains(type) || type.startsWith("fuse.");
+}
+
+// Spaces, tabs and newlines are octal-escaped in the mount table
+QString decodeMountPath(const QByteArray &path)
+{
+    QByteArray result;
+    result.reserve(path.size());
+
+    for (int i = 0; i < path.size(); ++i) {
+        if (path[i] == '\\' && i + 3 < path.size()) {
+            bool ok = false;
+            const int value = path.mid(i + 1, 3).toInt(&ok, 8);
+            if (ok) {
+                result.append(char(value));
+                i += 3;
+                continue;
+            }
+        }
+
+        result.append(path[i]);
+    }
+
+    return QFile::decodeName(result);
+}
+
+bool claimMount(const QString &mountPath)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    auto &state = s_mountStates[mountPath];
+
+    if (state.checkInProgress || Clock::now() < state.skipUntil) {
+        return false;
+    }
+
+    state.checkInProgress = true;
+    return true;
+}
+
+void releaseMount(const QString &mountPath, bool wasSlow)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    auto &state = s_mountStates[mountPath];
+    state.checkInProgress = false;
+
+    if (wasSlow) {
+        state.skipUntil = Clock::now() + s_slowMountBackoff;
+    }
+}
+
+} // namespace details
+
+namespace
+{
+Mounts readMounts()
+{
+    auto mounts = std::make_shared<std::vector<Mount>>();
+
+#ifdef Q_OS_LINUX
+    // We are not using statfs on the mount points on purpose,
+    // it blocks just like stat does when the mount has gone stale
+    QFile file(QStringLiteral("/proc/self/mounts"));
+
+    if (file.open(QIODevice::ReadOnly)) {
+        const auto lines = file.readAll().split('\n');
+
+        for (const auto &line : lines) {
+            const auto fields = line.split(' ');
+
+            if (fields.size() < 3) {
+                continue;
+            }
+
+            mounts->push_back({details::decodeMountPath(fields[1]), details::isRemoteFileSystem(fields[2])});
+        }
+    }
+#endif
+
+    // Longest mount points first, so that the first match is the right one
+    std::stable_sort(mounts->begin(), mounts->end(), [](const Mount &left, const Mount &right) {
+        return left.path.size() > right.path.size();
+    });
+
+    return mounts;
+}
+
+Mounts currentMounts()
+{
+    static Mounts s_mounts;
+    static Clock::time_point s_mountsRead;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    const auto now = Clock::now();
+    if (!s_mounts || now - s_mountsRead > s_mountTableLifetime) {
+        s_mounts = readMounts();
+        s_mountsRead = now;
+    }
+
+    return s_mounts;
+}
+
+const Mount *mountFor(const std::vector<Mount> &mounts, const QString &path)
+{
+    for (const auto &mount : mounts) {
+        if (mount.path == QLatin1String("/") //
+            || path == mount.path //
+            || (path.startsWith(mount.path) && path[mount.path.size()] == QLatin1Char('/'))) {
+            return &mount;
+        }
+    }
+
+    return nullptr;
+}
+
+// Releases the mount when the check is done, however it ends
+class MountClaim
+{
+public:
+    explicit MountClaim(QString mountPath)
+        : m_mountPath(std::move(mountPath))
+    {
+    }
+
+    ~MountClaim()
+    {
+        details::releaseMount(m_mountPath, m_wasSlow);
+    }
+
+    MountClaim(const MountClaim &) = delete;
+    MountClaim &operator=(const MountClaim &) = delete;
+
+    void setSlow()
+    {
+        m_wasSlow = true;
+    }
+
+private:
+    QString m_mountPath;
+    bool m_wasSlow = false;
+};
+
+QStringList findMissingOnRemoteMount(const QString &mountPath, const QStringList &resources)
+{
+    MountClaim claim(mountPath);
+
+    QStringList missingResources;
+
+    const auto start = Clock::now();
+
+    for (const auto &resource : resources) {
+        const auto checkStart = Clock::now();
+
+        // Unlike QFile::exists, we only treat the file as missing when
+        // the filesystem says so, not when the server does not respond
+        struct stat info;
+        const bool missing = ::stat(QFile::encodeName(resource).constData(), &info) != 0 && errno == ENOENT;
+
+        const auto checkEnd = Clock::now();
+
+        if (checkEnd - checkStart > s_slowCheckThreshold) {
+            qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "Mount" << mountPath << "is too slow, not checking it for a while";
+            claim.setSlow();
+            break;
+        }
+
+        if (missing) {
+            missingResources << resource;
+        }
+
+        if (checkEnd - start > s_mountTimeBudget) {
+            break;
+        }
+    }
+
+    return missingResources;
+}
+
+// Stat can block for minutes on a stale mount, so the remote mounts
+// are not checked in the worker thread, the database queries would
+// wait for them. The pool is never destroyed, destroying it would
+// wait for the threads that are stuck
+QThreadPool *remoteChecksPool()
+{
+    static const auto s_pool = [] {
+        auto pool = new QThreadPool();
+        pool->setMaxThreadCount(s_maxRemoteChecks);
+        return pool;
+    }();
+
+    return s_pool;
+}
+
+void checkRemoteMount(QObject *context, const QString &mountPath, const QStringList &resources, const MissingResourcesCallback &callback)
+{
+    if (!details::claimMount(mountPath)) {
+        return;
+    }
+
+    auto promise = std::make_shared<QPromise<QStringList>>();
+    auto future = promise->future();
+
+    promise->start();
+
+    // If all the threads are busy, some of them are probably stuck,
+    // there is no point in queueing the check behind them
+    const bool started = remoteChecksPool()->tryStart([promise, mountPath, resources] {
+        promise->addResult(findMissingOnRemoteMount(mountPath, resources));
+        promise->finish();
+    });
+
+    if (!started) {
+        details::releaseMount(mountPath, false);
+        return;
+    }
+
+    future.then(context, [callback](const QStringList &missingResources) {
+        if (!missingResources.isEmpty()) {
+            callback(missingResources);
+        }
+    });
+}
+
+struct LocalCheckResult {
+    QStringList missingResources;
+    QHash<QString, QStringList> remoteResources;
+};
+
+} // namespace
+
+void findMissingResources(QObject *context, const QStringList &resources, const MissingResourcesCallback &callback)
+{
+    WorkerThread::run([resources] {
+        const auto mounts = currentMounts();
+
+        LocalCheckResult result;
+
+        for (const auto &resource : resources) {
+            if (!resource.startsWith(QLatin1Char('/'))) {
+                continue;
+            }
+
+            const auto mount = mountFor(*mounts, resource);
+
+            if (mount && mount->isRemote) {
+                result.remoteResources[mount->path] << resource;
+
+            } else if (!QFile::exists(resource)) {
+                result.missingResources << resource;
+            }
+        }
+
+        return result;
+    }).then(context, [context, callback](const LocalCheckResult &result) {
+        // Local results first, they should not wait for the network
+        if (!result.missingResources.isEmpty()) {
+            callback(result.missingResources);
+        }
+
+        // Each remote mount is checked separately, so that one
+        // stale mount does not block checking the others
+        for (auto it = result.remoteResources.cbegin(); it != result.remoteResources.cend(); ++it) {
+            checkRemoteMount(context, it.key(), it.value(), callback);
+        }
+    });
+}
+
+} // namespace ExistenceChecker
@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef EXISTENCE_CHECKER_P_H
+#define EXISTENCE_CHECKER_P_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QStringList>
+
+#include <functional>
+
+namespace ExistenceChecker
+{
+typedef std::function<void(const QStringList &missingResources)> MissingResourcesCallback;
+
+/**
+ * Checks in the background which of the resources that are local paths
+ * do not exist anymore, and reports them through the callback.
+ *
+ * Resources on local filesystems are checked first, in the worker thread,
+ * and reported immediately. Resources on network or FUSE mounts are
+ * checked afterwards, in a small pool of threads of their own, each
+ * mount within a time budget. A mount that is slow to respond, or that
+ * still has an unfinished check from an earlier call (a stale sshfs
+ * mount, for example), is skipped for a while.
+ *
+ * @note The callback can be called more than once. It is called in the
+ * thread of the context object, and not after the object is destroyed.
+ */
+void findMissingResources(QObject *context, const QStringList &resources, const MissingResourcesCallback &callback);
+
+namespace details
+{
+/**
+ * Whether the filesystem type from the mount table is a network or
+ * a FUSE one, which can be slow or stop responding
+ */
+bool isRemoteFileSystem(const QByteArray &type);
+
+/**
+ * Decodes a path from the mount table
+ */
+QString decodeMountPath(const QByteArray &path);
+
+/**
+ * Marks the mount as being checked. Returns false if it is already being
+ * checked, or if it was slow recently, and it should be skipped for now
+ */
+bool claimMount(const QString &mountPath);
+
+/**
+ * Marks the check of the mount as done. A mount that was slow
+ * is not claimed again for a while
+ */
+void releaseMount(const QString &mountPath, bool wasSlow);
+
+} // namespace details
+
+} // namespace ExistenceChecker
+
+#endif // EXISTENCE_CHECKER_P_H
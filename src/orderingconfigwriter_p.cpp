@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "orderingconfigwriter_p.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QHash>
+#include <QTimer>
+
+// KDE
+#include <KConfig>
+#include <KConfigGroup>
+
+// STL
+#include <mutex>
+#include <utility>
+
+// Local
+#include "workerthread_p.h"
+
+namespace OrderingConfigWriter
+{
+namespace
+{
+// Long enough to collect the reorders from a drag and drop session
+constexpr int s_writeDelay = 1000;
+
+std::mutex s_mutex;
+QHash<QString, QStringList> s_pendingItems;
+bool s_writeScheduled = false;
+bool s_postRoutineAdded = false;
+
+} // namespace
+
+void schedule(const QString &group, const QStringList &items)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        s_pendingItems[group] = items;
+
+        if (s_writeScheduled) {
+            return;
+        }
+
+        s_writeScheduled = true;
+
+        if (!s_postRoutineAdded) {
+            s_postRoutineAdded = true;
+            qAddPostRoutine(flush);
+        }
+    }
+
+    QTimer::singleShot(s_writeDelay, WorkerThread::instance(), flush);
+}
+
+void flush()
+{
+    QHash<QString, QStringList> pendingItems;
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        pendingItems = std::exchange(s_pendingItems, {});
+        s_writeScheduled = false;
+    }
+
+    if (pendingItems.isEmpty()) {
+        return;
+    }
+
+    // The models use a shared config object that belongs to the main
+    // thread, we need a separate one. It merges our changes with the
+    // ones from the other processes when it syncs
+    KConfig config(QStringLiteral("kactivitymanagerd-statsrc"));
+
+    for (auto it = pendingItems.cbegin(); it != pendingItems.cend(); ++it) {
+        KConfigGroup(&config, it.key()).writeEntry("kactivitiesLinkedItemsOrder", it.value());
+    }
+
+    config.sync();
+}
+
+} // namespace OrderingConfigWriter
@@ -0,0 +1,32 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef ORDERING_CONFIG_WRITER_P_H
+#define ORDERING_CONFIG_WRITER_P_H
+
+#include <QString>
+#include <QStringList>
+
+namespace OrderingConfigWriter
+{
+/**
+ * Schedules saving the order of the linked items for the config group.
+ * The writes are delayed, so that a series of reorders is saved at once,
+ * and they are done in the worker thread.
+ *
+ * The writes that are still pending when the application quits
+ * are done when QCoreApplication is destroyed.
+ */
+void schedule(const QString &group, const QStringList &items);
+
+/**
+ * Saves the pending writes immediately, in the caller's thread
+ */
+void flush();
+
+} // namespace OrderingConfigWriter
+
+#endif // ORDERING_CONFIG_WRITER_P_H
@@ -0,0 +1,179 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "resourceinfocache_p.h"
+
+// Qt
+#include <QCache>
+
+// STL
+#include <mutex>
+
+// Local
+#include "workerthread_p.h"
+#include <utils/qsqlquery_iterator.h>
+
+namespace ResourceInfoCache
+{
+namespace
+{
+constexpr int s_cacheSize = 1000;
+
+// The entries without the information are for the resources
+// the database knows nothing about, so that they are not
+// looked up again for every event
+typedef std::optional<Info> Entry;
+
+std::mutex s_mutex;
+QCache<QString, Entry> s_cache(s_cacheSize);
+
+} // namespace
+
+std::optional<Info> cached(const QString &resource)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (const auto entry = s_cache.object(resource)) {
+        return *entry;
+    }
+
+    return std::nullopt;
+}
+
+void insert(const QString &resource, const Info &info)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    s_cache.insert(resource, new Entry(info));
+}
+
+QStringList cachedResources()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    QStringList result;
+
+    for (const auto &resource : s_cache.keys()) {
+        if (s_cache.object(resource)->has_value()) {
+            result << resource;
+        }
+    }
+
+    return result;
+}
+
+bool isCachedAsMissing(const QString &resource)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    const auto entry = s_cache.object(resource);
+    return entry && !entry->has_value();
+}
+
+std::optional<Info> find(const QString &resource)
+{
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        if (const auto entry = s_cache.object(resource)) {
+            return *entry;
+        }
+    }
+
+    using Common::Database;
+
+    const auto database = Database::instance(Database::ResourcesDatabase, Database::ReadOnly);
+
+    if (!database) {
+        return std::nullopt;
+    }
+
+    auto query = database->createQuery();
+
+    query.prepare(QStringLiteral(R"(
+        SELECT title, mimetype
+        FROM   ResourceInfo
+        WHERE  targettedResource = :resource
+        )"));
+    query.bindValue(QStringLiteral(":resource"), resource);
+    query.exec();
+
+    for (const auto &item : query) {
+        const Info info{item[0].toString(), item[1].toString()};
+        insert(resource, info);
+        return info;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_cache.insert(resource, new Entry());
+
+    return std::nullopt;
+}
+
+void updateTitle(const QString &resource, const QString &title)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (const auto entry = s_cache.object(resource); entry && entry->has_value()) {
+        (*entry)->title = title;
+    }
+}
+
+void updateMimetype(const QString &resource, const QString &mimetype)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (const auto entry = s_cache.object(resource); entry && entry->has_value()) {
+        (*entry)->mimetype = mimetype;
+    }
+}
+
+QFuture<QHash<QString, Info>> load(const QStringList &resources)
+{
+    return WorkerThread::run([resources] {
+        const auto result = loadFromDatabase(WorkerThread::database(), resources);
+
+        for (auto it = result.cbegin(); it != result.cend(); ++it) {
+            insert(it.key(), it.value());
+        }
+
+        return result;
+    });
+}
+
+QHash<QString, Info> loadFromDatabase(const Common::Database::Ptr &database, const QStringList &resources)
+{
+    QHash<QString, Info> result;
+
+    if (!database) {
+        return result;
+    }
+
+    Common::forEachParameterBatch(resources, [&](const QStringList &batch, const QString &placeholders) {
+        auto query = database->createQuery();
+
+        query.prepare(QStringLiteral(R"(
+            SELECT targettedResource, title, mimetype
+            FROM   ResourceInfo
+            WHERE  targettedResource IN (%1)
+            )")
+                          .arg(placeholders));
+
+        for (const auto &resource : batch) {
+            query.addBindValue(resource);
+        }
+
+        query.exec();
+
+        for (const auto &item : query) {
+            result[item[0].toString()] = Info{item[1].toString(), item[2].toString()};
+        }
+    });
+
+    return result;
+}
+
+} // namespace ResourceInfoCache
@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef RESOURCE_INFO_CACHE_P_H
+#define RESOURCE_INFO_CACHE_P_H
+
+#include <QFuture>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+#include <common/database/Database.h>
+
+namespace ResourceInfoCache
+{
+struct Info {
+    QString title;
+    QString mimetype;
+};
+
+/**
+ * Returns the title and mimetype of the resource if they are
+ * in the cache. The cache is shared between all the models
+ * in the process and only keeps the recently used resources.
+ */
+std::optional<Info> cached(const QString &resource);
+
+void insert(const QString &resource, const Info &info);
+
+/**
+ * Returns the resources that have their title and mimetype in the cache
+ */
+QStringList cachedResources();
+
+/**
+ * Returns the title and mimetype of the resource from the cache,
+ * or loads them from the database in the caller's thread.
+ * Returns nothing if the database has no information about it.
+ * That is cached as well, until the information is inserted.
+ */
+std::optional<Info> find(const QString &resource);
+
+/**
+ * Whether find has cached that the database has
+ * no information about the resource
+ */
+bool isCachedAsMissing(const QString &resource);
+
+/**
+ * These only update the resources that are already cached.
+ * The watchers' hub calls them when the database changes.
+ */
+void updateTitle(const QString &resource, const QString &title);
+void updateMimetype(const QString &resource, const QString &mimetype);
+
+/**
+ * Loads the title and mimetype for the resources in the worker thread,
+ * and adds them to the cache. The resources that have no information
+ * in the database are not included in the result.
+ */
+QFuture<QHash<QString, Info>> load(const QStringList &resources);
+
+/**
+ * Loads the title and mimetype for the resources from the database,
+ * in the caller's thread. The cache is not changed.
+ */
+QHash<QString, Info> loadFromDatabase(const Common::Database::Ptr &database, const QStringList &resources);
+
+} // namespace ResourceInfoCache
+
+#endif // RESOURCE_INFO_CACHE_P_H
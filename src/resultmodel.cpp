@@ -8,26 +8,39 @@
 #include "resultmodel.h"
 
 // Qt
+#include <QCache>
+#include <QCollator>
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QDebug>
-#include <QFile>
+#include <QPointer>
+#include <QSet>
 #include <QTimer>
 
 // STL
 #include <functional>
-#include <thread>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <utility>
 
 // KDE
 #include <KConfigGroup>
 #include <KSharedConfig>
 
 // Local
+#include "activitiessync_p.h"
 #include "cleaning.h"
+#include "existencechecker_p.h"
+#include "orderingconfigwriter_p.h"
 #include "plasma-activities-stats-logsettings.h"
 #include "plasmaactivities/consumer.h"
+#include "resourceinfocache_p.h"
+#include "resultsnapshot_p.h"
 #include "resultset.h"
+#include "resultset_p.h"
 #include "resultwatcher.h"
+#include "workerthread_p.h"
 #include <common/database/Database.h>
 #include <utils/member_matcher.h>
 #include <utils/qsqlquery_iterator.h>
@@ -37,6 +50,17 @@
 
 constexpr int s_defaultCacheSize = 50;
 
+// Roughly one frame
+constexpr int s_defaultUpdateInterval = 16;
+
+// How much memory the pages of results can take in the windowed mode,
+// unless the user sets a memory budget. Roughly twenty pages
+constexpr qint64 s_defaultWindowMemory = 1024 * 1024;
+
+// The next page is loaded in the background when
+// the view gets past this percentage of the cache
+constexpr int s_prefetchThreshold = 75;
+
 #define QDBG qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "PlasmaActivitiesStats(" << (void *)this << ")"
 
 namespace KActivities
@@ -48,9 +72,11 @@ using Common::Database;
 class ResultModelPrivate
 {
 public:
-    ResultModelPrivate(Query query, const QString &clientId, ResultModel *parent)
+    ResultModelPrivate(Query query, const QString &clientId, ResultModel::Options options, ResultModel *parent)
         : cache(this, clientId, query.limit())
         , query(query)
+        , clientId(clientId)
+        , options(options)
         , watcher(query)
         , hasMore(true)
         , database(Database::instance(Database::ResourcesDatabase, Database::ReadOnly))
@@ -62,6 +88,8 @@ public:
     ~ResultModelPrivate()
     {
         s_privates.removeAll(this);
+
+        saveSnapshot();
     }
 
     enum Fetch {
@@ -161,17 +189,53 @@ public:
                 d->repositionResult(resourcePosition, d->destinationFor(*resourcePosition));
             }
 
-            m_orderingConfig.writeEntry("kactivitiesLinkedItemsOrder", m_fixedOrderedItems);
-            m_orderingConfig.sync();
+            saveFixedOrderedItems();
+            notifyFixedOrderedItemsChanged();
+        }
 
-            // We need to notify others to reload
+        // The other models that show the same ordering
+        // only need to move their items around
+        inline void notifyFixedOrderedItemsChanged()
+        {
             for (const auto &other : std::as_const(s_privates)) {
-                if (other != d && other->cache.m_clientId == m_clientId) {
-                    other->fetch(FetchReset);
+                if (other != d && other->cache.m_clientId == m_clientId && other->cache.m_orderingConfig.name() == m_orderingConfig.name()) {
+                    other->cache.setFixedOrderedItems(m_fixedOrderedItems);
                 }
             }
         }
 
+        // Another model has reordered the linked items
+        inline void setFixedOrderedItems(const QStringList &fixedOrderedItems)
+        {
+            m_fixedOrderedItems = fixedOrderedItems;
+
+            // The client sort does not care about the user-defined order
+            if (d->hasClientSort() || d->query.selection() == Terms::UsedResources) {
+                return;
+            }
+
+            auto items = m_items;
+
+            if (d->hasCollatedOrder()) {
+                d->sortByCollatedOrder(items);
+                d->changeLayout(std::move(items));
+                return;
+            }
+
+            std::stable_sort(items.begin(), items.end(), FixedItemsLessThan(FixedItemsLessThan::PartialOrdering, *this));
+
+            applyItems(items);
+        }
+
+        // The config object is only updated in memory, it is written
+        // to the disk later, and not from the main thread
+        inline void saveFixedOrderedItems()
+        {
+            m_orderingConfig.writeEntry("kactivitiesLinkedItemsOrder", m_fixedOrderedItems, KConfigBase::WriteConfigFlags());
+
+            OrderingConfigWriter::schedule(m_orderingConfig.name(), m_fixedOrderedItems);
+        }
+
         inline void debug() const
         {
             for (const auto &item : m_items) {
@@ -193,8 +257,7 @@ public:
                 m_fixedOrderedItems = m_orderingConfig.readEntry("kactivitiesLinkedItemsOrder", QStringList());
             } else {
                 // Otherwise, copy the order from the previous activity to this one
-                m_orderingConfig.writeEntry("kactivitiesLinkedItemsOrder", m_fixedOrderedItems);
-                m_orderingConfig.sync();
+                saveFixedOrderedItems();
             }
         }
 
@@ -204,6 +267,11 @@ public:
         QList<ResultSet::Result> m_items;
         int m_countLimit;
 
+        // Changes whenever the items are added, removed or reordered,
+        // so that we know whether the data loaded in the background
+        // still fits the cache
+        int m_generation = 0;
+
         QString m_clientId;
         KSharedConfig::Ptr m_configFile;
         KConfigGroup m_orderingConfig;
@@ -261,16 +329,22 @@ public:
             return FindCacheResult(this, std::find_if(m_items.begin(), m_items.end(), member(&ResultSet::Result::resource) == resource));
         }
 
+        inline FindCacheResult findAt(int index)
+        {
+            return FindCacheResult(this, m_items.begin() + index);
+        }
+
+        // Returns the number of items that are less than the item
+        // the predicate is comparing against, skipping the item
+        // itself if it is already in the collection
         template<typename Predicate>
-        inline FindCacheResult lowerBoundWithSkippedResource(Predicate &&lessThanPredicate)
+        static inline int countLessThan(const Items &items, Predicate &&lessThanPredicate)
         {
             using namespace kamd::utils::member_matcher;
-            const int count = std::count_if(m_items.cbegin(), m_items.cend(), [&](const ResultSet::Result &result) {
+            return std::count_if(items.cbegin(), items.cend(), [&](const ResultSet::Result &result) {
                 return lessThanPredicate(result, _);
             });
 
-            return FindCacheResult(this, m_items.begin() + count);
-
             // using namespace kamd::utils::member_matcher;
             //
             // const auto position =
@@ -298,19 +372,73 @@ public:
         }
         //^
 
-        inline void insertAt(const FindCacheResult &at, const ResultSet::Result &result)
+        inline const ResultSet::Result &operator[](int index) const
         {
-            m_items.insert(at.iterator, result);
+            return m_items[index];
         }
 
-        inline void removeAt(const FindCacheResult &at)
+        inline const Items &items() const
         {
-            m_items.removeAt(at.index);
+            return m_items;
         }
 
-        inline const ResultSet::Result &operator[](int index) const
+        inline int generation() const
         {
-            return m_items[index];
+            return m_generation;
+        }
+
+        // Replaces the items with the same items in a different order,
+        // the caller needs to notify the views about the layout change
+        inline void reorder(Items items)
+        {
+            ++m_generation;
+            m_items = std::move(items);
+        }
+
+        // Returns the roles whose data differs between the two results
+        static QList<int> changedRoles(const ResultSet::Result &oldResult, const ResultSet::Result &newResult)
+        {
+            QList<int> roles;
+
+            const bool resourceChanged = oldResult.resource() != newResult.resource();
+            const bool titleChanged = oldResult.title() != newResult.title();
+            const bool scoreChanged = oldResult.score() != newResult.score();
+            const bool linkStatusChanged = oldResult.linkStatus() != newResult.linkStatus();
+
+            if (resourceChanged) {
+                roles << ResultModel::ResourceRole;
+            }
+            if (titleChanged) {
+                roles << ResultModel::TitleRole;
+            }
+            if (scoreChanged) {
+                roles << ResultModel::ScoreRole;
+            }
+            if (oldResult.firstUpdate() != newResult.firstUpdate()) {
+                roles << ResultModel::FirstUpdateRole;
+            }
+            if (oldResult.lastUpdate() != newResult.lastUpdate()) {
+                roles << ResultModel::LastUpdateRole;
+            }
+            if (linkStatusChanged) {
+                roles << ResultModel::LinkStatusRole;
+            }
+            if (ResultSet_ResultPrivate::linkedActivitiesDiffer(oldResult, newResult)) {
+                roles << ResultModel::LinkedActivitiesRole;
+            }
+            if (oldResult.mimetype() != newResult.mimetype()) {
+                roles << ResultModel::MimeType;
+            }
+            if (oldResult.agent() != newResult.agent()) {
+                roles << ResultModel::Agent;
+            }
+
+            // The display role is composed of these
+            if (resourceChanged || titleChanged || scoreChanged || linkStatusChanged) {
+                roles << Qt::DisplayRole;
+            }
+
+            return roles;
         }
 
         inline void clear()
@@ -319,14 +447,44 @@ public:
                 return;
             }
 
+            ++m_generation;
+
             d->q->beginRemoveRows(QModelIndex(), 0, m_items.size() - 1);
             m_items.clear();
             d->q->endRemoveRows();
         }
 
+        // Replaces the items starting at the specified position,
+        // and checks whether the new items still exist
+        inline void replace(const Items &newItems, int from = 0)
+        {
+            applyItems(newItems, from);
+            checkExistence(newItems);
+        }
+
+        inline void checkExistence(const Items &newItems)
+        {
+            // Check whether we got an item representing a non-existent file,
+            // if so, schedule its removal from the database.
+            // This is done in the background, and the checker is careful
+            // with resources on remote filesystems
+            QStringList resources;
+            resources.reserve(newItems.size());
+            for (const auto &item : newItems) {
+                resources << item.resource();
+            }
+
+            ExistenceChecker::findMissingResources(d->q, resources, [model = QPointer<ResultModel>(d->q)](const QStringList &missingResources) {
+                // This is called in the model's thread
+                if (model) {
+                    model->forgetResources(missingResources);
+                }
+            });
+        }
+
         //  Algorithm to calculate the edit operations to allow
         //_ replaceing items without model reset
-        inline void replace(const Items &newItems, int from = 0)
+        inline void applyItems(const Items &newItems, int from = 0)
         {
             using namespace kamd::utils::member_matcher;
 
@@ -372,6 +530,10 @@ public:
             // The main addition here compared to the original papers is that
             // our 'strings' can not hold two instances of the same element,
             // and that we support updating from arbitrary position.
+            //
+            // The generation only changes when the rows do, so that
+            // applying the same items does not throw away the page
+            // that was loaded in the background
 
             auto newBlockStart = newItems.cbegin();
 
@@ -408,6 +570,8 @@ public:
                     // This item was not found in the old cache, so we are
                     // inserting a new item at the same position it had in
                     // the newItems array
+                    ++m_generation;
+
                     d->q->beginInsertRows(QModelIndex(), newBlockStartIndex, newBlockStartIndex);
 
                     m_items.insert(newBlockStartIndex, *newBlockStart);
@@ -444,6 +608,8 @@ public:
                         // are getting a bad query which has duplicate
                         // results
 
+                        ++m_generation;
+
                         d->q->beginMoveRows(QModelIndex(), oldBlockStartIndex, oldBlockStartIndex + blockSize - 1, QModelIndex(), newBlockStartIndex);
 
                         // Moving the items from the old location to the new one
@@ -452,6 +618,27 @@ public:
                         d->q->endMoveRows();
                     }
 
+                    // The items are in their places, now we need to see
+                    // whether their data has changed
+                    for (int i = 0; i < blockSize; ++i) {
+                        auto &item = m_items[newBlockStartIndex + i];
+                        const auto &newItem = *(newBlockStart + i);
+
+                        const auto roles = changedRoles(item, newItem);
+
+                        if (!roles.isEmpty()) {
+                            ++m_generation;
+
+                            // The results from the database do not have the linked
+                            // activities loaded, there is no need to load them again
+                            auto updatedItem = newItem;
+                            ResultSet_ResultPrivate::keepLinkedActivities(updatedItem, item);
+                            item = std::move(updatedItem);
+
+                            Q_EMIT d->q->dataChanged(d->q->index(newBlockStartIndex + i), d->q->index(newBlockStartIndex + i), roles);
+                        }
+                    }
+
                     // Skip all the items in this block, and continue with
                     // the search
                     newBlockStart = newBlockEnd;
@@ -462,27 +649,6 @@ public:
             // but if the newItems list was shorter than needed, we still
             // need to trim the rest.
             trim(from + newItems.size());
-
-            // Check whether we got an item representing a non-existent file,
-            // if so, schedule its removal from the database
-            // we want to do this async so that we don't block
-            std::thread([=, this] {
-                QList<QString> missingResources;
-                for (const auto &item : newItems) {
-                    // QFile.exists() can be incredibly slow (eg. if resource is on remote filesystem)
-                    if (item.resource().startsWith(QLatin1Char('/')) && !QFile(item.resource()).exists()) {
-                        missingResources << item.resource();
-                    }
-                }
-
-                if (missingResources.empty()) {
-                    return;
-                }
-
-                QTimer::singleShot(0, this->d->q, [=, this] {
-                    d->q->forgetResources(missingResources);
-                });
-            }).detach();
         }
         //^
 
@@ -502,6 +668,8 @@ public:
             //   current cache (0, 1, 2, 3, 4, 5, 6, 7), size = 8
             // We need to delete from 5 to 7
 
+            ++m_generation;
+
             d->q->beginRemoveRows(QModelIndex(), limit, m_items.size() - 1);
             m_items.erase(m_items.begin() + limit, m_items.end());
             d->q->endRemoveRows();
@@ -565,11 +733,214 @@ public:
         //^
     };
 
-    inline Cache::FindCacheResult destinationFor(const ResultSet::Result &result)
+    //_ Sorting requested by the client, it overrides the query ordering
+    int clientSortRole = -1;
+    Qt::SortOrder clientSortOrder = Qt::AscendingOrder;
+    QCollator collator;
+
+    inline bool hasClientSort() const
+    {
+        return clientSortRole != -1;
+    }
+
+    // The titles are sorted with the collator, both when the client asks
+    // for it, and when the query orders by title. SQLite can only compare
+    // the titles byte by byte, so we sort the results it returns again
+    inline bool hasCollatedOrder() const
+    {
+        return hasClientSort() || query.ordering() == Terms::OrderByTitle;
+    }
+
+    // Since SQLite does not order the titles with the collator, a page
+    // it returns for a query ordered by title would not contain the first
+    // results in the collated order, and the next pages would insert the
+    // results above the ones that are already shown. For these queries,
+    // all the results up to the limit are loaded at once
+    inline int pageSize() const
+    {
+        return query.ordering() == Terms::OrderByTitle ? query.limit() : s_defaultCacheSize;
+    }
+
+    // Comparing the collation keys is much cheaper than comparing
+    // the strings with the collator, so we are keeping the keys
+    // for the titles and mimetypes we have seen
+    mutable QHash<QString, QCollatorSortKey> sortKeys;
+
+    // Returns a copy, the reference would not survive adding another key
+    QCollatorSortKey sortKey(const QString &string) const
+    {
+        auto it = sortKeys.constFind(string);
+
+        if (it == sortKeys.cend()) {
+            // The keys for the strings we do not have anymore are not
+            // worth tracking, it is cheaper to start from scratch
+            if (sortKeys.size() > 4 * qMax(cache.size(), s_defaultCacheSize)) {
+                sortKeys.clear();
+            }
+
+            it = sortKeys.emplace(string, collator.sortKey(string));
+        }
+
+        return *it;
+    }
+
+    template<typename T>
+    static int compareValues(const T &left, const T &right)
+    {
+        return left < right ? -1 : right < left ? 1 : 0;
+    }
+
+    int compareForClientSort(const ResultSet::Result &left, const ResultSet::Result &right) const
+    {
+        switch (clientSortRole) {
+        case ResultModel::TitleRole:
+            return sortKey(left.title()).compare(sortKey(right.title()));
+        case ResultModel::MimeType:
+            return sortKey(left.mimetype()).compare(sortKey(right.mimetype()));
+        case ResultModel::ScoreRole:
+            return compareValues(left.score(), right.score());
+        case ResultModel::LastUpdateRole:
+            return compareValues(left.lastUpdate(), right.lastUpdate());
+        case ResultModel::FirstUpdateRole:
+            return compareValues(left.firstUpdate(), right.firstUpdate());
+        default:
+            return 0;
+        }
+    }
+
+    // Follows the query ordering for OrderByTitle - the linked resources
+    // in the user-defined order, linked before non-linked ones, then
+    // the titles. The ties are broken by the resource, so that the order
+    // is stable regardless of the order in which the results came in
+    bool isBeforeInCollatedOrder(const ResultSet::Result &left, const ResultSet::Result &right) const
+    {
+        int comparison = 0;
+
+        if (hasClientSort()) {
+            comparison = compareForClientSort(left, right);
+
+            if (clientSortOrder == Qt::DescendingOrder) {
+                comparison = -comparison;
+            }
+
+        } else {
+            if (query.selection() != Terms::UsedResources) {
+                const FixedItemsLessThan fixedItemsLessThan(FixedItemsLessThan::PartialOrdering, cache);
+
+                if (fixedItemsLessThan(left, right)) {
+                    return true;
+                } else if (fixedItemsLessThan(right, left)) {
+                    return false;
+                }
+            }
+
+            if (query.selection() == Terms::AllResources && left.linkStatus() != right.linkStatus()) {
+                return left.linkStatus() > right.linkStatus();
+            }
+
+            comparison = sortKey(left.title()).compare(sortKey(right.title()));
+        }
+
+        return comparison != 0 ? comparison < 0 : left.resource() < right.resource();
+    }
+
+    void sortByCollatedOrder(Cache::Items &items) const
+    {
+        std::sort(items.begin(), items.end(), [this](const ResultSet::Result &left, const ResultSet::Result &right) {
+            return isBeforeInCollatedOrder(left, right);
+        });
+    }
+
+    void sortItems(Qt::SortOrder sortOrder, int role)
+    {
+        // Going back to the query ordering
+        if (role == -1) {
+            if (hasClientSort()) {
+                clientSortRole = -1;
+                changeLayout(itemsInQueryOrder());
+            }
+            return;
+        }
+
+        if (role != ResultModel::TitleRole && role != ResultModel::MimeType && role != ResultModel::ScoreRole && role != ResultModel::LastUpdateRole
+            && role != ResultModel::FirstUpdateRole) {
+            qCWarning(PLASMA_ACTIVITIES_STATS_LOG) << "The results can not be sorted by role" << role;
+            return;
+        }
+
+        if (options & ResultModel::Windowed) {
+            qCWarning(PLASMA_ACTIVITIES_STATS_LOG) << "The results can not be sorted in the windowed mode";
+            return;
+        }
+
+        clientSortRole = role;
+        clientSortOrder = sortOrder;
+
+        auto items = cache.items();
+        sortByCollatedOrder(items);
+
+        changeLayout(std::move(items));
+    }
+
+    // The cached items in the order specified by the query
+    Cache::Items itemsInQueryOrder() const
+    {
+        auto items = cache.items();
+
+        if (hasCollatedOrder()) {
+            sortByCollatedOrder(items);
+            return items;
+        }
+
+        Cache::Items result;
+        result.reserve(items.size());
+
+        for (const auto &item : std::as_const(items)) {
+            result.insert(destinationIndexFor(result, item), item);
+        }
+
+        return result;
+    }
+
+    // Replaces the items with the same ones in a different order
+    void changeLayout(Cache::Items items)
+    {
+        Q_EMIT q->layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+        QHash<QString, int> newRows;
+        newRows.reserve(items.size());
+        for (int row = 0; row < items.size(); ++row) {
+            newRows[items[row].resource()] = row;
+        }
+
+        const auto oldIndexes = q->persistentIndexList();
+        QModelIndexList newIndexes;
+        newIndexes.reserve(oldIndexes.size());
+        for (const auto &index : oldIndexes) {
+            newIndexes << q->index(newRows.value(cache[index.row()].resource()));
+        }
+
+        cache.reorder(std::move(items));
+
+        q->changePersistentIndexList(oldIndexes, newIndexes);
+
+        Q_EMIT q->layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+    //^
+
+    // Returns the position the result should have in the specified
+    // list of items, according to the query ordering
+    inline int destinationIndexFor(const Cache::Items &items, const ResultSet::Result &result) const
     {
         using namespace kamd::utils::member_matcher;
         using namespace Terms;
 
+        if (hasCollatedOrder()) {
+            return std::count_if(items.cbegin(), items.cend(), [&](const ResultSet::Result &item) {
+                return item.resource() != result.resource() && isBeforeInCollatedOrder(item, result);
+            });
+        }
+
         const auto resource = result.resource();
         const auto score = result.score();
         const auto firstUpdate = result.firstUpdate();
@@ -580,8 +951,8 @@ public:
 #define ORDER_BY(Field) member(&ResultSet::Result::Field) > Field
 #define ORDER_BY_FULL(Field)                                                                                                                                   \
     (query.selection() == Terms::AllResources                                                                                                                  \
-         ? cache.lowerBoundWithSkippedResource(FIXED_ITEMS_LESS_THAN && ORDER_BY(linkStatus) && ORDER_BY(Field) && ORDER_BY(resource))                         \
-         : cache.lowerBoundWithSkippedResource(FIXED_ITEMS_LESS_THAN && ORDER_BY(Field) && ORDER_BY(resource)))
+         ? Cache::countLessThan(items, FIXED_ITEMS_LESS_THAN && ORDER_BY(linkStatus) && ORDER_BY(Field) && ORDER_BY(resource))                                 \
+         : Cache::countLessThan(items, FIXED_ITEMS_LESS_THAN && ORDER_BY(Field) && ORDER_BY(resource)))
 
         const auto destination = query.ordering() == HighScoredFirst ? ORDER_BY_FULL(score)
             : query.ordering() == RecentlyUsedFirst                  ? ORDER_BY_FULL(lastUpdate)
@@ -595,15 +966,9 @@ public:
         return destination;
     }
 
-    inline void removeResult(const Cache::FindCacheResult &result)
+    inline Cache::FindCacheResult destinationFor(const ResultSet::Result &result)
     {
-        q->beginRemoveRows(QModelIndex(), result.index, result.index);
-        cache.removeAt(result);
-        q->endRemoveRows();
-
-        if (query.selection() != Terms::LinkedResources) {
-            fetch(cache.size(), 1);
-        }
+        return cache.findAt(destinationIndexFor(cache.items(), result));
     }
 
     inline void repositionResult(const Cache::FindCacheResult &result, const Cache::FindCacheResult &destination)
@@ -613,8 +978,6 @@ public:
         const int oldPosition = result.index;
         int position = destination.index;
 
-        Q_EMIT q->dataChanged(q->index(oldPosition), q->index(oldPosition));
-
         if (oldPosition == position) {
             return;
         }
@@ -637,174 +1000,1047 @@ public:
         fetch(FetchReload);
     }
 
-    void init()
+    // The changes to the links do not change the last update of the
+    // results, reloadChanged would not notice the missed ones
+    void onChangesMissed()
     {
-        using namespace std::placeholders;
-
-        QObject::connect(&watcher, &ResultWatcher::resultScoreUpdated, q, std::bind(&ResultModelPrivate::onResultScoreUpdated, this, _1, _2, _3, _4));
-        QObject::connect(&watcher, &ResultWatcher::resultRemoved, q, std::bind(&ResultModelPrivate::onResultRemoved, this, _1));
-        QObject::connect(&watcher, &ResultWatcher::resultLinked, q, std::bind(&ResultModelPrivate::onResultLinked, this, _1));
-        QObject::connect(&watcher, &ResultWatcher::resultUnlinked, q, std::bind(&ResultModelPrivate::onResultUnlinked, this, _1));
-
-        QObject::connect(&watcher, &ResultWatcher::resourceTitleChanged, q, std::bind(&ResultModelPrivate::onResourceTitleChanged, this, _1, _2));
-        QObject::connect(&watcher, &ResultWatcher::resourceMimetypeChanged, q, std::bind(&ResultModelPrivate::onResourceMimetypeChanged, this, _1, _2));
-
-        QObject::connect(&watcher, &ResultWatcher::resultsInvalidated, q, std::bind(&ResultModelPrivate::reload, this));
-
-        if (query.activities().contains(CURRENT_ACTIVITY_TAG)) {
-            QObject::connect(&activities,
-                             &KActivities::Consumer::currentActivityChanged,
-                             q,
-                             std::bind(&ResultModelPrivate::onCurrentActivityChanged, this, _1));
+        if (query.selection() == Terms::UsedResources) {
+            reloadChanged();
+        } else {
+            reload();
         }
-
-        fetch(FetchReset);
     }
 
-    void fetch(const int from, int count)
+    // Instead of reading all the cached results again, we are only
+    // reading the ones that were updated since we last saw the data,
+    // and checking which of the cached ones were removed
+    void reloadChanged()
     {
         using namespace Terms;
 
-        if (from + count > query.limit()) {
-            count = query.limit() - from;
-        }
-
-        if (count <= 0) {
+        if (cache.size() == 0 || options & ResultModel::Windowed) {
+            reload();
             return;
         }
 
-        // In order to see whether there are more results, we need to pass
-        // the count increased by one
-        ResultSet results(query | Offset(from) | Limit(count + 1));
-
-        auto it = results.begin();
+        // There might be updates waiting to be applied, they
+        // need to be in the cache before we compare it to the database
+        applyPendingUpdates();
 
-        Cache::Items newItems;
+        const int previousSize = cache.size();
 
-        while (count-- > 0 && it != results.end()) {
-            newItems << *it;
-            ++it;
+        QStringList cachedResources;
+        cachedResources.reserve(previousSize);
+        for (const auto &item : cache.items()) {
+            cachedResources << item.resource();
         }
 
-        hasMore = (it != results.end());
+        const auto survivingResources = details::survivingResources(query, cachedResources);
 
-        // We need to sort the new items for the linked resources
-        // user-defined reordering. This needs only to be a partial sort,
-        // the main sorting is done by sqlite
-        if (query.selection() != Terms::UsedResources) {
-            std::stable_sort(newItems.begin(), newItems.end(), FixedItemsLessThan(FixedItemsLessThan::PartialOrdering, cache));
+        // If an updated result would end up in the cache, it is
+        // among the first previousSize of the updated results
+        const auto updatedItems = details::resultsUpdatedSince(query | Offset(0) | Limit(previousSize), lastUpdateWatermark);
+
+        QSet<QString> updatedResources;
+        for (const auto &item : updatedItems) {
+            updatedResources << item.resource();
+            lastUpdateWatermark = qMax(lastUpdateWatermark, item.lastUpdate());
         }
 
-        cache.replace(newItems, from);
-    }
+        QDBG << "Reloading changed results:" << updatedItems.size() << "updated," << (previousSize - survivingResources.size()) << "removed";
 
-    void fetch(Fetch mode)
-    {
-        if (mode == FetchReset) {
-            // Removing the previously cached data
-            // and loading all from scratch
-            cache.clear();
+        Cache::Items items;
+        items.reserve(previousSize + updatedItems.size());
 
-            const QString activityTag = query.activities().contains(CURRENT_ACTIVITY_TAG) //
-                ? (QStringLiteral("-ForActivity-") + activities.currentActivity())
-                : QStringLiteral("-ForAllActivities");
+        for (const auto &item : cache.items()) {
+            if (survivingResources.contains(item.resource()) && !updatedResources.contains(item.resource())) {
+                items << item;
+            }
+        }
 
-            cache.loadOrderingConfig(activityTag);
+        for (const auto &item : updatedItems) {
+            const int index = destinationIndexFor(items, item);
 
-            // If the user has requested less than 50 entries, only fetch those. If more, they should be fetched in subsequent batches
-            fetch(0, qMin(s_defaultCacheSize, query.limit()));
+            // If there are more results in the database than in the cache,
+            // we can not know whether the result belongs at the end of the
+            // cache. It will be loaded with the rest if it does
+            if (index == items.size() && hasMore) {
+                continue;
+            }
 
-        } else if (mode == FetchReload) {
-            if (cache.size() > s_defaultCacheSize) {
-                // If the cache is big, we are pretending
-                // we were asked to reset the model
-                fetch(FetchReset);
+            items.insert(index, item);
+        }
 
-            } else {
-                // We are only updating the currently
-                // cached items, nothing more
-                fetch(0, cache.size());
-            }
+        cache.applyItems(items);
+        cache.trim();
 
-        } else { // FetchMore
-            // Load a new batch of data
-            fetch(cache.size(), s_defaultCacheSize);
+        if (cache.size() < previousSize) {
+            fetch(cache.size(), previousSize - cache.size());
         }
     }
 
-    void onResultScoreUpdated(const QString &resource, double score, uint lastUpdate, uint firstUpdate)
+    void init()
     {
-        QDBG << "ResultModelPrivate::onResultScoreUpdated "
-             << "result added:" << resource << "score:" << score << "last:" << lastUpdate << "first:" << firstUpdate;
+        using namespace std::placeholders;
 
-        // This can also be called when the resource score
-        // has been updated, so we need to check whether
-        // we already have it in the cache
-        const auto result = cache.find(resource);
+        QObject::connect(&watcher, &ResultWatcher::resultScoreUpdated, q, std::bind(&ResultModelPrivate::onResultScoreUpdated, this, _1, _2, _3, _4));
+        QObject::connect(&watcher, &ResultWatcher::resultRemoved, q, std::bind(&ResultModelPrivate::onResultRemoved, this, _1));
+        QObject::connect(&watcher, &ResultWatcher::resultLinked, q, std::bind(&ResultModelPrivate::onResultLinked, this, _1));
+        QObject::connect(&watcher, &ResultWatcher::resultUnlinked, q, std::bind(&ResultModelPrivate::onResultUnlinked, this, _1));
 
-        ResultSet::Result::LinkStatus linkStatus = result ? result->linkStatus()
-            : query.selection() != Terms::UsedResources   ? ResultSet::Result::Unknown
-            : query.selection() != Terms::LinkedResources ? ResultSet::Result::Linked
-                                                          : ResultSet::Result::NotLinked;
+        QObject::connect(&watcher, &ResultWatcher::resourceTitleChanged, q, std::bind(&ResultModelPrivate::onResourceTitleChanged, this, _1, _2));
+        QObject::connect(&watcher, &ResultWatcher::resourceMimetypeChanged, q, std::bind(&ResultModelPrivate::onResourceMimetypeChanged, this, _1, _2));
 
-        if (result) {
-            // We are only updating a result we already had,
-            // lets fill out the data and send the update signal.
-            // Move it if necessary.
+        QObject::connect(&watcher, &ResultWatcher::resultsInvalidated, q, std::bind(&ResultModelPrivate::reloadChanged, this));
+        QObject::connect(&watcher, &ResultWatcher::changesMissed, q, std::bind(&ResultModelPrivate::onChangesMissed, this));
 
-            auto &item = *result.iterator;
+        collator.setNumericMode(true);
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
 
-            item.setScore(score);
-            item.setLinkStatus(linkStatus);
-            item.setLastUpdate(lastUpdate);
-            item.setFirstUpdate(firstUpdate);
+        pendingUpdatesTimer.setSingleShot(true);
+        pendingUpdatesTimer.setInterval(s_defaultUpdateInterval);
+        QObject::connect(&pendingUpdatesTimer, &QTimer::timeout, q, std::bind(&ResultModelPrivate::applyPendingUpdates, this));
 
-            repositionResult(result, destinationFor(item));
+        if (query.activities().contains(CURRENT_ACTIVITY_TAG)) {
+            ActivitiesSync::onCurrentActivityChanged(q, std::bind(&ResultModelPrivate::onCurrentActivityChanged, this, _1));
+        }
 
-        } else {
-            // We do not have the resource in the cache,
-            // lets fill out the data and insert it
-            // at the desired position
+        if (options & ResultModel::WarmStartSnapshot && !(options & ResultModel::Windowed)) {
+            useSnapshot = true;
 
-            ResultSet::Result result;
-            result.setResource(resource);
+            if (startFromSnapshot()) {
+                return;
+            }
+        }
 
-            result.setTitle(QStringLiteral(" "));
-            result.setMimetype(QStringLiteral(" "));
-            fillTitleAndMimetype(result);
+        fetch(FetchReset);
+    }
 
-            result.setScore(score);
-            result.setLinkStatus(linkStatus);
-            result.setLastUpdate(lastUpdate);
-            result.setFirstUpdate(firstUpdate);
+    void loadOrderingConfig()
+    {
+        // Only the queries for the current activity need to know it
+        shownActivity = query.activities().contains(CURRENT_ACTIVITY_TAG) ? ActivitiesSync::currentActivity() : QString();
 
-            const auto destination = destinationFor(result);
+        const QString activityTag = query.activities().contains(CURRENT_ACTIVITY_TAG) //
+            ? (QStringLiteral("-ForActivity-") + shownActivity)
+            : QStringLiteral("-ForAllActivities");
 
-            q->beginInsertRows(QModelIndex(), destination.index, destination.index);
+        cache.loadOrderingConfig(activityTag);
+    }
 
-            cache.insertAt(destination, result);
+    //_ Starting with the results the previous instance of the model had
+    bool useSnapshot = false;
 
-            q->endInsertRows();
+    // The reconciliation with the database is not needed
+    // anymore if the model has been reset in the meantime
+    int resetCount = 0;
 
-            cache.trim();
-        }
-    }
+    bool startFromSnapshot()
+    {
+        // We need to know which activity we are showing before
+        // we know which snapshot to load
+        loadOrderingConfig();
+
+        const auto name = snapshotName();
+        const auto items = name.isEmpty() ? Cache::Items() : ResultSnapshot::load(name);
+
+        if (items.isEmpty()) {
+            return false;
+        }
+
+        hasMore = true;
+        cache.applyItems(items);
+
+        // The snapshot might be outdated, we are replacing it with what is
+        // in the database. The diff only changes the rows that differ
+        reconcile(qMax(int(items.size()), pageSize()));
+
+        return true;
+    }
+
+    // Replaces the items we are showing with the ones from the database,
+    // in the background if we can
+    void reconcile(int count)
+    {
+        count = qMin(count, query.limit());
+
+        const int expectedResetCount = resetCount;
+
+        const auto apply = [this, expectedResetCount](Page page) {
+            if (resetCount != expectedResetCount) {
+                return;
+            }
+
+            applyPage(std::move(page), 0);
+            saveSnapshot();
+        };
+
+        const auto resolved = resolvedQuery();
+
+        if (!resolved) {
+            // We do not know the current activity yet, so the worker
+            // can not load the results. Lets show what we have until
+            // we do, and then load them here
+            ActivitiesSync::whenReady(q, [this, count, apply] {
+                const auto resolved = resolvedQuery();
+                apply(loadPage(resolved ? *resolved : query, 0, count));
+            });
+            return;
+        }
+
+        WorkerThread::run([query = *resolved, count] {
+            return loadPage(query, 0, count);
+        }).then(q, apply);
+    }
+
+    // Each activity has its own snapshot when the query is for the current one
+    QString snapshotName() const
+    {
+        if (!useSnapshot) {
+            return QString();
+        }
+
+        Query snapshotQuery = query;
+
+        if (query.activities().contains(CURRENT_ACTIVITY_TAG)) {
+            if (shownActivity.isEmpty()) {
+                return QString();
+            }
+
+            snapshotQuery.removeActivities({CURRENT_ACTIVITY_TAG});
+            snapshotQuery.addActivities({shownActivity});
+        }
+
+        return ResultSnapshot::name(clientId, snapshotQuery);
+    }
+
+    void saveSnapshot() const
+    {
+        const auto name = snapshotName();
+
+        if (name.isEmpty()) {
+            return;
+        }
+
+        auto items = cache.items().mid(0, s_defaultCacheSize);
+
+        if (!QCoreApplication::instance()) {
+            // The worker thread is already gone
+            ResultSnapshot::save(name, items);
+            return;
+        }
+
+        WorkerThread::run([name, items = std::move(items)] {
+            ResultSnapshot::save(name, items);
+            return true;
+        });
+    }
+    //^
+
+    struct Page {
+        Cache::Items items;
+        bool hasMore = false;
+    };
+
+    // This is called from the worker thread as well,
+    // so it must not touch the model
+    static Page loadPage(const Query &query, int from, int count)
+    {
+        using namespace Terms;
+
+        Page page;
+
+        // In order to see whether there are more results, we need to pass
+        // the count increased by one
+        ResultSet results(query | Offset(from) | Limit(count < std::numeric_limits<int>::max() ? count + 1 : count));
+
+        auto it = results.begin();
+
+        while (count-- > 0 && it != results.end()) {
+            page.items << *it;
+            ++it;
+        }
+
+        page.hasMore = (it != results.end());
+
+        return page;
+    }
+
+    void fetch(const int from, int count)
+    {
+        if (from + count > query.limit()) {
+            count = query.limit() - from;
+        }
+
+        if (count <= 0) {
+            return;
+        }
+
+        applyPage(loadPage(query, from, count), from);
+    }
+
+    void applyPage(Page page, int from)
+    {
+        auto &newItems = page.items;
+
+        hasMore = page.hasMore;
+
+        for (const auto &item : std::as_const(newItems)) {
+            lastUpdateWatermark = qMax(lastUpdateWatermark, item.lastUpdate());
+        }
+
+        // The other models, and the updates that come later,
+        // can reuse the titles and mimetypes we have just loaded
+        for (const auto &item : std::as_const(newItems)) {
+            ResourceInfoCache::insert(item.resource(), {item.title(), item.mimetype()});
+        }
+
+        // If the results are sorted by us, not by the database, the new
+        // ones need to be sorted together with the ones we already have
+        if (hasCollatedOrder()) {
+            auto items = cache.items().mid(0, from);
+
+            // The updates might have inserted some of the results
+            // while the page was loading, they must not appear twice
+            QSet<QString> cachedResources;
+            cachedResources.reserve(items.size());
+            for (const auto &item : std::as_const(items)) {
+                cachedResources << item.resource();
+            }
+
+            for (const auto &item : std::as_const(newItems)) {
+                if (!cachedResources.contains(item.resource())) {
+                    items << item;
+                }
+            }
+
+            sortByCollatedOrder(items);
+
+            cache.applyItems(items);
+            cache.checkExistence(newItems);
+            return;
+        }
+
+        // We need to sort the new items for the linked resources
+        // user-defined reordering. This needs only to be a partial sort,
+        // the main sorting is done by sqlite
+        if (query.selection() != Terms::UsedResources) {
+            std::stable_sort(newItems.begin(), newItems.end(), FixedItemsLessThan(FixedItemsLessThan::PartialOrdering, cache));
+        }
+
+        cache.replace(newItems, from);
+    }
+
+    //_ Loading the next page in the background before the view needs it
+    struct PrefetchedPage {
+        Page page;
+        int from;
+        int generation;
+    };
+
+    std::optional<PrefetchedPage> prefetchedPage;
+    bool prefetchInProgress = false;
+
+    // The query with the ':current' activity and agent replaced
+    // by the actual values, since the worker thread can not ask
+    // the activity manager for the current activity
+    std::optional<Query> resolvedQuery()
+    {
+        Query result = query;
+
+        if (query.activities().contains(CURRENT_ACTIVITY_TAG)) {
+            const auto currentActivity = ActivitiesSync::currentActivity();
+
+            if (currentActivity.isEmpty()) {
+                return std::nullopt;
+            }
+
+            result.removeActivities({CURRENT_ACTIVITY_TAG});
+            result.addActivities({currentActivity});
+        }
+
+        if (query.agents().contains(CURRENT_AGENT_TAG)) {
+            result.removeAgents({CURRENT_AGENT_TAG});
+            result.addAgents({QCoreApplication::applicationName()});
+        }
+
+        return result;
+    }
+
+    void prefetchIfNeeded(int row)
+    {
+        if (options & ResultModel::Windowed || prefetchInProgress || row < cache.size() * s_prefetchThreshold / 100) {
+            return;
+        }
+
+        const int from = cache.size();
+
+        if (!hasMore || !isWithinMemoryBudget() || (prefetchedPage && prefetchedPage->from == from && prefetchedPage->generation == cache.generation())) {
+            return;
+        }
+
+        const int count = qMin(pageSize(), query.limit() - from);
+
+        if (count <= 0) {
+            return;
+        }
+
+        const auto resolved = resolvedQuery();
+
+        if (!resolved) {
+            return;
+        }
+
+        prefetchInProgress = true;
+        prefetchedPage.reset();
+
+        const int generation = cache.generation();
+
+        WorkerThread::run([query = *resolved, from, count] {
+            return loadPage(query, from, count);
+        }).then(q, [this, from, generation](const Page &page) {
+            prefetchInProgress = false;
+
+            // If the cache has changed in the meantime, the page
+            // might not be the one that comes after it anymore
+            if (generation != cache.generation()) {
+                return;
+            }
+
+            prefetchedPage = PrefetchedPage{page, from, generation};
+        });
+    }
+
+    bool applyPrefetchedPage()
+    {
+        if (!prefetchedPage) {
+            return false;
+        }
+
+        auto prefetched = std::move(*prefetchedPage);
+        prefetchedPage.reset();
+
+        if (prefetched.from != cache.size() || prefetched.generation != cache.generation()) {
+            return false;
+        }
+
+        applyPage(std::move(prefetched.page), prefetched.from);
+
+        return true;
+    }
+    //^
+
+    void fetch(Fetch mode)
+    {
+        if (options & ResultModel::Windowed) {
+            if (mode == FetchReset) {
+                resetWindow();
+            } else if (mode == FetchReload) {
+                refreshWindow();
+            }
+            return;
+        }
+
+        if (mode == FetchReset) {
+            // Removing the previously cached data
+            // and loading all from scratch. The updates we have
+            // collected so far are not relevant anymore
+            clearPendingUpdates();
+            cache.clear();
+            sortKeys.clear();
+            lastUpdateWatermark = 0;
+            ++resetCount;
+
+            loadOrderingConfig();
+
+            // If the user has requested less than 50 entries, only fetch those. If more, they should be fetched in subsequent batches
+            fetch(0, qMin(pageSize(), query.limit()));
+
+        } else if (mode == FetchReload) {
+            if (cache.size() > pageSize()) {
+                // If the cache is big, we are pretending
+                // we were asked to reset the model
+                fetch(FetchReset);
+
+            } else {
+                // We are only updating the currently
+                // cached items, nothing more
+                fetch(0, cache.size());
+            }
+
+        } else { // FetchMore
+            if (!isWithinMemoryBudget()) {
+                return;
+            }
+
+            // Load a new batch of data, unless we have already
+            // loaded it in the background
+            if (!applyPrefetchedPage()) {
+                fetch(cache.size(), pageSize());
+            }
+        }
+    }
+
+    //_ Windowed mode, only the recently accessed pages are kept in memory
+    int windowSize = 0;
+    // The cost of a page is its estimated size in bytes
+    QCache<int, Cache::Items> windowPages{s_defaultWindowMemory};
+    QSet<int> loadingWindowPages;
+
+    // Changes whenever the loaded pages stop being valid,
+    // so that the late results from the worker are ignored
+    int windowGeneration = 0;
+
+    int size() const
+    {
+        return options & ResultModel::Windowed ? windowSize : cache.size();
+    }
+
+    const ResultSet::Result *resultAt(int row)
+    {
+        if (row < 0 || row >= size()) {
+            return nullptr;
+        }
+
+        if (!(options & ResultModel::Windowed)) {
+            prefetchIfNeeded(row);
+            return &cache[row];
+        }
+
+        const int page = row / s_defaultCacheSize;
+        const auto items = windowPages.object(page);
+
+        if (!items) {
+            loadWindowPage(page);
+            return nullptr;
+        }
+
+        const int index = row % s_defaultCacheSize;
+        return index < items->size() ? &items->at(index) : nullptr;
+    }
+
+    // The linked activities are not loaded with the results. When a view
+    // asks for them, we load them for the whole page around the row in
+    // the worker thread, and tell the view when they arrive. Each resource
+    // remembers the request that is loading it, the older ones are ignored
+    QHash<QString, quint64> loadingLinkedActivities;
+    quint64 linkedActivitiesRequest = 0;
+
+    void loadLinkedActivities(int row)
+    {
+        const auto result = resultAt(row);
+
+        if (!result || ResultSet_ResultPrivate::get(*result)->linkedActivitiesLoaded || loadingLinkedActivities.contains(result->resource())) {
+            return;
+        }
+
+        const int first = row - row % s_defaultCacheSize;
+        const int last = qMin(first + s_defaultCacheSize, size()) - 1;
+        const auto request = ++linkedActivitiesRequest;
+
+        QStringList resources;
+
+        for (int current = first; current <= last; ++current) {
+            const auto item = options & ResultModel::Windowed ? resultAt(current) : &cache[current];
+
+            if (item && !ResultSet_ResultPrivate::get(*item)->linkedActivitiesLoaded && !loadingLinkedActivities.contains(item->resource())) {
+                resources << item->resource();
+                loadingLinkedActivities[item->resource()] = request;
+            }
+        }
+
+        WorkerThread::run([resources] {
+            return details::linkedActivities(WorkerThread::database(), resources);
+        }).then(q, [this, resources, request](const QHash<QString, QStringList> &linkedActivities) {
+            for (const auto &resource : resources) {
+                if (loadingLinkedActivities.value(resource) != request) {
+                    continue;
+                }
+
+                loadingLinkedActivities.remove(resource);
+
+                // The item might have been removed while we were loading
+                int row = -1;
+                ResultSet::Result *result = nullptr;
+
+                if (options & ResultModel::Windowed) {
+                    std::tie(row, result) = findInWindow(resource);
+
+                } else if (const auto found = cache.find(resource)) {
+                    row = found.index;
+                    result = &*found;
+                }
+
+                if (!result || ResultSet_ResultPrivate::get(*result)->linkedActivitiesLoaded) {
+                    continue;
+                }
+
+                result->setLinkedActivities(linkedActivities.value(resource));
+
+                Q_EMIT q->dataChanged(q->index(row), q->index(row), {ResultModel::LinkedActivitiesRole});
+            }
+        });
+    }
+
+    void resetWindow()
+    {
+        clearPendingUpdates();
+
+        q->beginResetModel();
+
+        windowPages.clear();
+        loadingWindowPages.clear();
+        ++windowGeneration;
+
+        windowSize = qMin(details::countResults(query), query.limit());
+
+        // The first page is loaded right away, the view
+        // is going to ask for it immediately anyway
+        if (windowSize > 0) {
+            insertWindowPage(0, loadPage(query, 0, s_defaultCacheSize).items);
+        }
+
+        q->endResetModel();
+    }
+
+    // Drops the loaded pages, the number of results is only
+    // counted again if the results might have been added or removed
+    void refreshWindow(bool recount = true)
+    {
+        const auto loadedPages = windowPages.keys();
+
+        windowPages.clear();
+        loadingWindowPages.clear();
+        ++windowGeneration;
+
+        if (recount) {
+            const int newSize = qMin(details::countResults(query), query.limit());
+
+            if (newSize > windowSize) {
+                q->beginInsertRows(QModelIndex(), windowSize, newSize - 1);
+                windowSize = newSize;
+                q->endInsertRows();
+
+            } else if (newSize < windowSize) {
+                q->beginRemoveRows(QModelIndex(), newSize, windowSize - 1);
+                windowSize = newSize;
+                q->endRemoveRows();
+            }
+        }
+
+        // The views could only show the rows from the pages we had,
+        // they will ask for them, and we will load the pages again
+        for (const int page : loadedPages) {
+            const int first = page * s_defaultCacheSize;
+            const int last = qMin(first + s_defaultCacheSize, windowSize) - 1;
+
+            if (first <= last) {
+                Q_EMIT q->dataChanged(q->index(first), q->index(last));
+            }
+        }
+    }
+
+    void loadWindowPage(int page, bool waitForActivities = true)
+    {
+        if (loadingWindowPages.contains(page)) {
+            return;
+        }
+
+        const auto resolved = resolvedQuery();
+
+        if (!resolved) {
+            // We do not know the current activity yet, the page
+            // is loaded when we do. We are not waiting again if
+            // the activity manager does not know it either
+            if (waitForActivities) {
+                loadingWindowPages << page;
+
+                ActivitiesSync::whenReady(q, [this, page, generation = windowGeneration] {
+                    if (generation != windowGeneration) {
+                        return;
+                    }
+
+                    loadingWindowPages.remove(page);
+                    loadWindowPage(page, false);
+                });
+            }
+
+            return;
+        }
+
+        loadingWindowPages << page;
+
+        // If we have the previous page, we can continue after its last
+        // result instead of making the database skip all the preceding ones
+        std::optional<ResultSet::Result> previous;
+        if (const auto previousItems = windowPages.object(page - 1)) {
+            if (previousItems->size() == s_defaultCacheSize && details::canSeekAfter(query, previousItems->last())) {
+                previous = previousItems->last();
+            }
+        }
+
+        const int generation = windowGeneration;
+
+        WorkerThread::run([query = *resolved, page, previous] {
+            using namespace Terms;
+
+            return previous ? details::resultsAfter(query | Offset(0) | Limit(s_defaultCacheSize), *previous)
+                            : loadPage(query, page * s_defaultCacheSize, s_defaultCacheSize).items;
+        }).then(q, [this, page, generation](const Cache::Items &items) {
+            if (generation != windowGeneration) {
+                return;
+            }
+
+            loadingWindowPages.remove(page);
+
+            const int first = page * s_defaultCacheSize;
+            const int last = qMin(first + s_defaultCacheSize, windowSize) - 1;
+
+            if (first > last) {
+                return;
+            }
+
+            // Inserting the page can evict the one that was used the least recently
+            insertWindowPage(page, items);
+
+            Q_EMIT q->dataChanged(q->index(first), q->index(last));
+        });
+    }
+
+    void insertWindowPage(int page, const Cache::Items &items)
+    {
+        const auto cost = itemsMemoryUsage(items);
+
+        // We always need to be able to keep at least one page,
+        // otherwise the view would never get its data
+        windowPages.setMaxCost(qMax(memoryBudget > 0 ? memoryBudget : s_defaultWindowMemory, cost));
+        windowPages.insert(page, new Cache::Items(items), cost);
+    }
 
-    void onResultRemoved(const QString &resource)
+    // Finds the result in the pages that are in memory,
+    // returns the row and the result
+    std::pair<int, ResultSet::Result *> findInWindow(const QString &resource)
     {
-        const auto result = cache.find(resource);
+        const auto pages = windowPages.keys();
 
-        if (!result) {
+        for (const int page : pages) {
+            auto items = windowPages.object(page);
+
+            for (int index = 0; index < items->size(); ++index) {
+                if ((*items)[index].resource() == resource) {
+                    return {page * s_defaultCacheSize + index, &(*items)[index]};
+                }
+            }
+        }
+
+        return {-1, nullptr};
+    }
+    //^
+
+    //_ Memory use
+    qint64 memoryBudget = 0;
+
+    // Calculating the footprint needs to go through all the items,
+    // we are only doing it again when the items change
+    mutable qint64 cachedFootprint = 0;
+    mutable int cachedFootprintGeneration = -1;
+
+    static qint64 itemsMemoryUsage(const Cache::Items &items)
+    {
+        qint64 result = 0;
+        for (const auto &item : items) {
+            result += details::estimatedMemoryUsage(item);
+        }
+        return result;
+    }
+
+    qint64 memoryFootprint() const
+    {
+        if (options & ResultModel::Windowed) {
+            return windowPages.totalCost();
+        }
+
+        if (cachedFootprintGeneration != cache.generation()) {
+            cachedFootprint = itemsMemoryUsage(cache.items());
+            cachedFootprintGeneration = cache.generation();
+        }
+
+        return cachedFootprint;
+    }
+
+    bool isWithinMemoryBudget() const
+    {
+        return memoryBudget <= 0 || memoryFootprint() < memoryBudget;
+    }
+
+    void setMemoryBudget(qint64 bytes)
+    {
+        memoryBudget = qMax<qint64>(0, bytes);
+
+        if (options & ResultModel::Windowed) {
+            windowPages.setMaxCost(memoryBudget > 0 ? memoryBudget : s_defaultWindowMemory);
+        }
+    }
+    //^
+
+    //_ Collecting the updates from the watcher and applying them in one go
+    struct PendingUpdate {
+        enum Type {
+            ScoreUpdated,
+            Removed,
+            Unlinked,
+        };
+
+        Type type;
+        double score;
+        uint lastUpdate;
+        uint firstUpdate;
+    };
+
+    // The updates are deduplicated per resource, only the last
+    // one is kept. The list keeps the order in which the resources
+    // first appeared so that the updates are applied predictably
+    QStringList pendingResources;
+    QHash<QString, PendingUpdate> pendingUpdates;
+    QTimer pendingUpdatesTimer;
+
+    void scheduleUpdate(const QString &resource, const PendingUpdate &update)
+    {
+        if (!pendingUpdates.contains(resource)) {
+            pendingResources << resource;
+        }
+
+        pendingUpdates[resource] = update;
+
+        // We are not restarting the timer if it is already running,
+        // the updates should not be postponed indefinitely
+        if (!pendingUpdatesTimer.isActive()) {
+            pendingUpdatesTimer.start();
+        }
+    }
+
+    void clearPendingUpdates()
+    {
+        pendingUpdatesTimer.stop();
+        pendingResources.clear();
+        pendingUpdates.clear();
+    }
+
+    void applyPendingUpdates()
+    {
+        pendingUpdatesTimer.stop();
+
+        if (pendingResources.isEmpty()) {
+            return;
+        }
+
+        const auto resources = std::exchange(pendingResources, {});
+        const auto updates = std::exchange(pendingUpdates, {});
+
+        QDBG << "Applying" << resources.size() << "collected updates";
+
+        if (options & ResultModel::Windowed) {
+            applyWindowUpdates(resources, updates);
             return;
         }
 
-        if (query.selection() == Terms::UsedResources || result->linkStatus() != ResultSet::Result::Linked) {
-            removeResult(result);
+        // The items that need to be (re)inserted into the cache
+        // at the position defined by the query ordering
+        Cache::Items placedItems;
+
+        // The items whose positions are going to change - either
+        // because they are being removed, or they need to be placed again
+        QSet<QString> displacedResources;
+
+        // The inserted items we do not have the title and mimetype for
+        QStringList unknownResources;
+
+        int removedCount = 0;
+        bool needsReload = false;
+
+        for (const auto &resource : resources) {
+            const auto update = updates.value(resource);
+            const auto result = cache.find(resource);
+
+            switch (update.type) {
+            case PendingUpdate::ScoreUpdated: {
+                // This can also be called when the resource score
+                // has been updated, so we need to check whether
+                // we already have it in the cache
+                const auto linkStatus = result ? result->linkStatus()
+                    : query.selection() != Terms::UsedResources   ? ResultSet::Result::Unknown
+                    : query.selection() != Terms::LinkedResources ? ResultSet::Result::Linked
+                                                                  : ResultSet::Result::NotLinked;
+
+                if (result) {
+                    // We are only updating a result we already had,
+                    // lets fill out the data, the cached item will
+                    // be updated and moved if necessary
+                    ResultSet::Result item = *result;
+
+                    item.setScore(update.score);
+                    item.setLinkStatus(linkStatus);
+                    item.setLastUpdate(update.lastUpdate);
+                    item.setFirstUpdate(update.firstUpdate);
+
+                    placedItems << item;
+
+                } else {
+                    // We do not have the resource in the cache,
+                    // lets fill out the data and insert it
+                    // at the desired position
+                    ResultSet::Result item;
+                    item.setResource(resource);
+
+                    // If we do not know the title and mimetype, the item
+                    // gets a placeholder until they are loaded
+                    if (const auto info = ResourceInfoCache::cached(resource)) {
+                        item.setTitle(info->title);
+                        item.setMimetype(info->mimetype);
+
+                    } else {
+                        item.setTitle(QStringLiteral(" "));
+                        item.setMimetype(QStringLiteral(" "));
+                        unknownResources << resource;
+                    }
+
+                    item.setScore(update.score);
+                    item.setLinkStatus(linkStatus);
+                    item.setLastUpdate(update.lastUpdate);
+                    item.setFirstUpdate(update.firstUpdate);
+
+                    placedItems << item;
+                }
+
+                displacedResources << resource;
+                lastUpdateWatermark = qMax(lastUpdateWatermark, update.lastUpdate);
+                break;
+            }
+
+            case PendingUpdate::Removed:
+                if (result && (query.selection() == Terms::UsedResources || result->linkStatus() != ResultSet::Result::Linked)) {
+                    displacedResources << resource;
+                    ++removedCount;
+                }
+                break;
+
+            case PendingUpdate::Unlinked:
+                if (!result) {
+                    break;
+                }
+
+                if (query.selection() == Terms::LinkedResources) {
+                    displacedResources << resource;
+                    ++removedCount;
+
+                } else if (query.selection() == Terms::AllResources) {
+                    // When the result is unlinked, it might go away or not
+                    // depending on its previous usage
+                    needsReload = true;
+                }
+                break;
+            }
+        }
+
+        // The items that were not touched keep their relative order,
+        // the updated ones are placed one by one where they belong
+        Cache::Items items;
+        items.reserve(cache.size() + placedItems.size());
+
+        for (const auto &item : cache.items()) {
+            if (!displacedResources.contains(item.resource())) {
+                items << item;
+            }
+        }
+
+        for (const auto &item : std::as_const(placedItems)) {
+            items.insert(destinationIndexFor(items, item), item);
+        }
+
+        // Moving, inserting and removing the rows in the model
+        // with as few signals as we can. This also notifies about
+        // the roles that have changed for the updated rows
+        cache.applyItems(items);
+        cache.trim();
+
+        if (removedCount > 0 && query.selection() != Terms::LinkedResources) {
+            fetch(cache.size(), removedCount);
+        }
+
+        if (needsReload) {
+            reload();
+        }
+
+        if (!unknownResources.isEmpty()) {
+            loadResourceInfo(unknownResources);
+        }
+    }
+
+    // Updates the rows we have loaded in place. If the results might have
+    // moved, or if some were added or removed, we can not know where they
+    // are without loading them, so the loaded pages are dropped
+    void applyWindowUpdates(const QStringList &resources, const QHash<QString, PendingUpdate> &updates)
+    {
+        using namespace Terms;
+
+        const int orderingRole = query.ordering() == HighScoredFirst ? ResultModel::ScoreRole
+            : query.ordering() == RecentlyUsedFirst                  ? ResultModel::LastUpdateRole
+            : query.ordering() == RecentlyCreatedFirst               ? ResultModel::FirstUpdateRole
+                                                                     : -1;
+
+        bool resultsMightChange = false;
+        bool orderMightChange = false;
+
+        for (const auto &resource : resources) {
+            const auto update = updates.value(resource);
+            const auto [row, result] = findInWindow(resource);
+
+            if (update.type != PendingUpdate::ScoreUpdated || !result) {
+                resultsMightChange = true;
+                continue;
+            }
+
+            ResultSet::Result item = *result;
+            item.setScore(update.score);
+            item.setLastUpdate(update.lastUpdate);
+            item.setFirstUpdate(update.firstUpdate);
+
+            const auto roles = Cache::changedRoles(*result, item);
+
+            if (roles.isEmpty()) {
+                continue;
+            }
+
+            if (roles.contains(orderingRole)) {
+                orderMightChange = true;
+            }
+
+            *result = item;
+            Q_EMIT q->dataChanged(q->index(row), q->index(row), roles);
+        }
+
+        if (resultsMightChange || orderMightChange) {
+            refreshWindow(resultsMightChange);
         }
     }
 
+    void onResultScoreUpdated(const QString &resource, double score, uint lastUpdate, uint firstUpdate)
+    {
+        QDBG << "ResultModelPrivate::onResultScoreUpdated "
+             << "result added:" << resource << "score:" << score << "last:" << lastUpdate << "first:" << firstUpdate;
+
+        scheduleUpdate(resource, {PendingUpdate::ScoreUpdated, score, lastUpdate, firstUpdate});
+    }
+
+    void onResultRemoved(const QString &resource)
+    {
+        scheduleUpdate(resource, {PendingUpdate::Removed, 0, 0, 0});
+    }
+
     void onResultLinked(const QString &resource)
     {
+        forgetLinkedActivities(resource);
+
         if (query.selection() != Terms::UsedResources) {
             onResultScoreUpdated(resource, 0, 0, 0);
         }
@@ -812,90 +2048,288 @@ public:
 
     void onResultUnlinked(const QString &resource)
     {
-        const auto result = cache.find(resource);
+        forgetLinkedActivities(resource);
 
-        if (!result) {
-            return;
+        scheduleUpdate(resource, {PendingUpdate::Unlinked, 0, 0, 0});
+    }
+
+    // The linked activities we have loaded for the resource are not
+    // valid anymore, the views will ask for them again if they care
+    void forgetLinkedActivities(const QString &resource)
+    {
+        int row = -1;
+        ResultSet::Result *result = nullptr;
+
+        if (options & ResultModel::Windowed) {
+            std::tie(row, result) = findInWindow(resource);
+
+        } else if (const auto found = cache.find(resource)) {
+            row = found.index;
+            result = &*found;
         }
 
-        if (query.selection() == Terms::LinkedResources) {
-            removeResult(result);
+        // What is being loaded might be from before the change
+        loadingLinkedActivities.remove(resource);
 
-        } else if (query.selection() == Terms::AllResources) {
-            // When the result is unlinked, it might go away or not
-            // depending on its previous usage
-            reload();
+        if (!result || !ResultSet_ResultPrivate::get(*result)->linkedActivitiesLoaded) {
+            return;
         }
+
+        ResultSet_ResultPrivate::forgetLinkedActivities(*result);
+
+        Q_EMIT q->dataChanged(q->index(row), q->index(row), {ResultModel::LinkedActivitiesRole});
     }
+    //^
 
     Query query;
+    const QString clientId;
+    const ResultModel::Options options;
     ResultWatcher watcher;
     bool hasMore;
 
+    // The newest lastUpdate of the results we have seen so far
+    uint lastUpdateWatermark = 0;
+
+    // The current activity comes from ActivitiesSync, so that the model
+    // agrees with the watcher, this is only for the running activities
     KActivities::Consumer activities;
+
+    // The queries in the main thread reuse this connection
+    // instead of opening the database every time
     Common::Database::Ptr database;
 
     //_ Title and mimetype functions
-    void fillTitleAndMimetype(ResultSet::Result &result)
+
+    // When we are sorting the results by the role whose data
+    // has changed, the result might need to move
+    void repositionForCollatedOrder(const QString &resource, int role)
     {
-        if (!database) {
+        if (hasClientSort() ? clientSortRole != role : (role != ResultModel::TitleRole || query.ordering() != Terms::OrderByTitle)) {
             return;
         }
 
-        auto query = database->execQuery(QStringLiteral("SELECT "
-                                                        "title, mimetype "
-                                                        "FROM "
-                                                        "ResourceInfo "
-                                                        "WHERE "
-                                                        "targettedResource = '")
-                                         + result.resource() + QStringLiteral("'"));
+        const auto result = cache.find(resource);
 
-        // Only one item at most
-        for (const auto &item : query) {
-            result.setTitle(item[QStringLiteral("title")].toString());
-            result.setMimetype(item[QStringLiteral("mimetype")].toString());
+        if (result) {
+            repositionResult(result, destinationFor(*result));
         }
     }
 
+    void loadResourceInfo(const QStringList &resources)
+    {
+        ResourceInfoCache::load(resources).then(q, [this](const QHash<QString, ResourceInfoCache::Info> &infos) {
+            for (auto it = infos.cbegin(); it != infos.cend(); ++it) {
+                // The item might have been removed while we were loading
+                const auto result = cache.find(it.key());
+
+                if (!result) {
+                    continue;
+                }
+
+                QList<int> roles;
+
+                if (result->title() != it->title) {
+                    result->setTitle(it->title);
+                    roles << ResultModel::TitleRole << Qt::DisplayRole;
+                }
+
+                if (result->mimetype() != it->mimetype) {
+                    result->setMimetype(it->mimetype);
+                    roles << ResultModel::MimeType;
+                }
+
+                if (!roles.isEmpty()) {
+                    Q_EMIT q->dataChanged(q->index(result.index), q->index(result.index), roles);
+
+                    repositionForCollatedOrder(it.key(), ResultModel::TitleRole);
+                    repositionForCollatedOrder(it.key(), ResultModel::MimeType);
+                }
+            }
+        });
+    }
+
     void onResourceTitleChanged(const QString &resource, const QString &title)
     {
+        ResourceInfoCache::updateTitle(resource, title);
+
+        if (options & ResultModel::Windowed) {
+            const auto [row, result] = findInWindow(resource);
+
+            if (result && result->title() != title) {
+                result->setTitle(title);
+                Q_EMIT q->dataChanged(q->index(row), q->index(row), {ResultModel::TitleRole, Qt::DisplayRole});
+            }
+
+            return;
+        }
+
         const auto result = cache.find(resource);
 
         if (!result) {
             return;
         }
 
+        if (result->title() == title) {
+            return;
+        }
+
         result->setTitle(title);
 
-        Q_EMIT q->dataChanged(q->index(result.index), q->index(result.index));
+        Q_EMIT q->dataChanged(q->index(result.index), q->index(result.index), {ResultModel::TitleRole, Qt::DisplayRole});
+
+        repositionForCollatedOrder(resource, ResultModel::TitleRole);
     }
 
     void onResourceMimetypeChanged(const QString &resource, const QString &mimetype)
     {
         // TODO: This can add or remove items from the model
 
+        ResourceInfoCache::updateMimetype(resource, mimetype);
+
+        if (options & ResultModel::Windowed) {
+            const auto [row, result] = findInWindow(resource);
+
+            if (result && result->mimetype() != mimetype) {
+                result->setMimetype(mimetype);
+                Q_EMIT q->dataChanged(q->index(row), q->index(row), {ResultModel::MimeType});
+            }
+
+            return;
+        }
+
         const auto result = cache.find(resource);
 
         if (!result) {
             return;
         }
 
+        if (result->mimetype() == mimetype) {
+            return;
+        }
+
         result->setMimetype(mimetype);
 
-        Q_EMIT q->dataChanged(q->index(result.index), q->index(result.index));
+        Q_EMIT q->dataChanged(q->index(result.index), q->index(result.index), {ResultModel::MimeType});
+
+        repositionForCollatedOrder(resource, ResultModel::MimeType);
     }
     //^
 
+    //_ Warm caches of the recently used activities, so that switching
+    // to them does not leave the model empty until the results are loaded
+    static constexpr int s_maxWarmActivities = 4;
+
+    // The activity the items in the cache belong to
+    QString shownActivity;
+
+    QCache<QString, Page> warmCaches{s_maxWarmActivities};
+    QSet<QString> loadingWarmCaches;
+
+    void keepWarmCache()
+    {
+        if (shownActivity.isEmpty() || cache.size() == 0) {
+            return;
+        }
+
+        warmCaches.insert(shownActivity, new Page{cache.items().mid(0, pageSize()), hasMore || cache.size() > pageSize()});
+    }
+
+    bool switchToWarmCache(const QString &activity)
+    {
+        auto warm = warmCaches.take(activity);
+
+        if (!warm) {
+            return false;
+        }
+
+        // Like FetchReset, but we are replacing the items
+        // instead of removing them all
+        clearPendingUpdates();
+        sortKeys.clear();
+        lastUpdateWatermark = 0;
+        ++resetCount;
+
+        loadOrderingConfig();
+
+        const int count = warm->items.size();
+        applyPage(std::move(*warm), 0);
+        delete warm;
+
+        // The warm cache might be outdated
+        reconcile(qMax(count, pageSize()));
+
+        return true;
+    }
+
+    // Loads the results for the other running activities in the background
+    void prefetchWarmCaches()
+    {
+        const auto running = activities.runningActivities();
+
+        for (const auto &activity : running) {
+            if (warmCaches.size() + loadingWarmCaches.size() >= s_maxWarmActivities) {
+                return;
+            }
+
+            if (activity == shownActivity || warmCaches.contains(activity) || loadingWarmCaches.contains(activity)) {
+                continue;
+            }
+
+            Query activityQuery = query;
+            activityQuery.removeActivities({CURRENT_ACTIVITY_TAG});
+            activityQuery.addActivities({activity});
+
+            if (query.agents().contains(CURRENT_AGENT_TAG)) {
+                activityQuery.removeAgents({CURRENT_AGENT_TAG});
+                activityQuery.addAgents({QCoreApplication::applicationName()});
+            }
+
+            loadingWarmCaches << activity;
+
+            WorkerThread::run([query = activityQuery, count = qMin(pageSize(), query.limit())] {
+                return loadPage(query, 0, count);
+            }).then(q, [this, activity](Page page) {
+                loadingWarmCaches.remove(activity);
+
+                if (activity != shownActivity && !warmCaches.contains(activity)) {
+                    warmCaches.insert(activity, new Page(std::move(page)));
+                }
+            });
+        }
+    }
+
     void onCurrentActivityChanged(const QString &activity)
     {
-        Q_UNUSED(activity);
         // If the current activity has changed, and
         // the query lists items for the ':current' one,
-        // reset the model (not a simple refresh this time)
-        if (query.activities().contains(CURRENT_ACTIVITY_TAG)) {
+        // reset the model (not a simple refresh this time),
+        // unless we already have the results for the activity
+        if (!query.activities().contains(CURRENT_ACTIVITY_TAG)) {
+            return;
+        }
+
+        // The model might have loaded the results after the activity
+        // became known, without waiting for the notification
+        if (activity == shownActivity) {
+            return;
+        }
+
+        if (options & ResultModel::Windowed) {
+            fetch(FetchReset);
+            return;
+        }
+
+        // The results we have are still the ones for the previous activity
+        saveSnapshot();
+        keepWarmCache();
+
+        if (!switchToWarmCache(activity)) {
             fetch(FetchReset);
         }
+
+        prefetchWarmCaches();
     }
+    //^
 
 private:
     ResultModel *const q;
@@ -906,14 +2340,21 @@ QList<ResultModelPrivate *> ResultModelPrivate::s_privates;
 
 ResultModel::ResultModel(Query query, QObject *parent)
     : QAbstractListModel(parent)
-    , d(new ResultModelPrivate(query, QString(), this))
+    , d(new ResultModelPrivate(query, QString(), NoOptions, this))
 {
     d->init();
 }
 
 ResultModel::ResultModel(Query query, const QString &clientId, QObject *parent)
     : QAbstractListModel(parent)
-    , d(new ResultModelPrivate(query, clientId, this))
+    , d(new ResultModelPrivate(query, clientId, NoOptions, this))
+{
+    d->init();
+}
+
+ResultModel::ResultModel(Query query, const QString &clientId, Options options, QObject *parent)
+    : QAbstractListModel(parent)
+    , d(new ResultModelPrivate(query, clientId, options, this))
 {
     d->init();
 }
@@ -941,21 +2382,27 @@ QVariant ResultModel::data(const QModelIndex &item, int role) const
 {
     const auto row = item.row();
 
-    if (row < 0 || row >= d->cache.size()) {
+    // They are empty until they are loaded
+    if (role == LinkedActivitiesRole) {
+        d->loadLinkedActivities(row);
+    }
+
+    const auto resultPtr = d->resultAt(row);
+
+    if (!resultPtr) {
         return QVariant();
     }
 
-    const auto &result = d->cache[row];
+    const auto &result = *resultPtr;
 
-    return role == Qt::DisplayRole     ? QString(result.title() + QStringLiteral(" ") + result.resource() + QStringLiteral(" - ")
-                                             + QString::number(result.linkStatus()) + QStringLiteral(" - ") + QString::number(result.score()))
+    return role == Qt::DisplayRole     ? ResultSet_ResultPrivate::displayString(result)
         : role == ResourceRole         ? result.resource()
         : role == TitleRole            ? result.title()
         : role == ScoreRole            ? result.score()
         : role == FirstUpdateRole      ? result.firstUpdate()
         : role == LastUpdateRole       ? result.lastUpdate()
         : role == LinkStatusRole       ? result.linkStatus()
-        : role == LinkedActivitiesRole ? result.linkedActivities()
+        : role == LinkedActivitiesRole ? ResultSet_ResultPrivate::get(result)->linkedActivities
         : role == MimeType             ? result.mimetype()
         : role == Agent                ? result.agent()
                                        : QVariant();
@@ -971,7 +2418,7 @@ QVariant ResultModel::headerData(int section, Qt::Orientation orientation, int r
 
 int ResultModel::rowCount(const QModelIndex &parent) const
 {
-    return parent.isValid() ? 0 : d->cache.size();
+    return parent.isValid() ? 0 : d->size();
 }
 
 void ResultModel::fetchMore(const QModelIndex &parent)
@@ -984,7 +2431,10 @@ void ResultModel::fetchMore(const QModelIndex &parent)
 
 bool ResultModel::canFetchMore(const QModelIndex &parent) const
 {
-    return parent.isValid() ? false : d->cache.size() >= d->query.limit() ? false : d->hasMore;
+    return parent.isValid() || d->options & Windowed ? false
+        : d->cache.size() >= d->query.limit()        ? false
+        : !d->isWithinMemoryBudget()                 ? false
+                                                     : d->hasMore;
 }
 
 void ResultModel::forgetResources(const QList<QString> &resources)
@@ -1007,14 +2457,17 @@ void ResultModel::forgetResource(const QString &resource)
 
 void ResultModel::forgetResource(int row)
 {
-    if (row >= d->cache.size()) {
+    const auto result = d->resultAt(row);
+
+    if (!result) {
         return;
     }
+    const auto resource = result->resource();
     const auto lstActivities = d->query.activities();
     for (const QString &activity : lstActivities) {
         const auto lstAgents = d->query.agents();
         for (const QString &agent : lstAgents) {
-            Stats::forgetResource(activity, agent == CURRENT_AGENT_TAG ? QCoreApplication::applicationName() : agent, d->cache[row].resource());
+            Stats::forgetResource(activity, agent == CURRENT_AGENT_TAG ? QCoreApplication::applicationName() : agent, resource);
         }
     }
 }
@@ -1029,10 +2482,39 @@ void ResultModel::setResultPosition(const QString &resource, int position)
     d->cache.setLinkedResultPosition(resource, position);
 }
 
+void ResultModel::setUpdateInterval(int msec)
+{
+    d->pendingUpdatesTimer.setInterval(qMax(0, msec));
+}
+
+int ResultModel::updateInterval() const
+{
+    return d->pendingUpdatesTimer.interval();
+}
+
+void ResultModel::setMemoryBudget(qint64 bytes)
+{
+    d->setMemoryBudget(bytes);
+}
+
+qint64 ResultModel::memoryBudget() const
+{
+    return d->memoryBudget;
+}
+
+qint64 ResultModel::memoryFootprint() const
+{
+    return d->memoryFootprint();
+}
+
 void ResultModel::sortItems(Qt::SortOrder sortOrder)
 {
-    // TODO
-    Q_UNUSED(sortOrder);
+    d->sortItems(sortOrder, TitleRole);
+}
+
+void ResultModel::sortItems(Qt::SortOrder sortOrder, int role)
+{
+    d->sortItems(sortOrder, role);
 }
 
 void ResultModel::linkToActivity(const QUrl &resource, const Terms::Activity &activity, const Terms::Agent &agent)
@@ -36,8 +36,44 @@ class PLASMAACTIVITIESSTATS_EXPORT ResultModel : public QAbstractListModel
     Q_OBJECT
 
 public:
+    /**
+     * Options that change how the model keeps its results
+     * @since 6.0
+     */
+    enum Option {
+        NoOptions = 0,
+        /**
+         * Only the pages of results that were accessed recently are kept
+         * in memory, the others are loaded again when they are needed.
+         * The model reports the total number of results up front,
+         * so it does not need fetchMore.
+         *
+         * This is meant for the queries with a large limit, like
+         * a browser for the complete history. The user-defined order
+         * of the linked resources is not supported in this mode.
+         */
+        Windowed = 1,
+        /**
+         * The model saves the results it has when it is destroyed,
+         * and the next model with the same client id and query
+         * starts by showing them, before the results are loaded
+         * from the database in the background.
+         *
+         * This is meant for the clients that need to show the results
+         * as soon as possible after they start. It is ignored
+         * in the windowed mode.
+         */
+        WarmStartSnapshot = 2,
+    };
+    Q_DECLARE_FLAGS(Options, Option)
+    Q_FLAG(Options)
+
     ResultModel(Query query, QObject *parent = nullptr);
     ResultModel(Query query, const QString &clientId, QObject *parent = nullptr);
+    /**
+     * @since 6.0
+     */
+    ResultModel(Query query, const QString &clientId, Options options, QObject *parent = nullptr);
     ~ResultModel() override;
 
     enum Roles {
@@ -47,7 +83,7 @@ public:
         FirstUpdateRole = Qt::UserRole + 3,
         LastUpdateRole = Qt::UserRole + 4,
         LinkStatusRole = Qt::UserRole + 5,
-        LinkedActivitiesRole = Qt::UserRole + 6,
+        LinkedActivitiesRole = Qt::UserRole + 6, // Since 6.0, loaded in the background, empty until then
         MimeType = Qt::UserRole + 7, // @since 5.77
         Agent = Qt::UserRole + 8, // @since 6.0
     };
@@ -69,6 +105,51 @@ public:
                             const Terms::Activity &activity = Terms::Activity(QStringList()),
                             const Terms::Agent &agent = Terms::Agent(QStringList()));
 
+    /**
+     * Sets for how long the changes reported by the activity manager
+     * are collected before they are applied to the model.
+     *
+     * The collected changes are applied in one go, so opening
+     * many documents at once does not reorder the model once
+     * per document. Zero means that the changes are applied as soon
+     * as the control returns to the event loop.
+     *
+     * The default is 16 milliseconds, roughly one frame.
+     * @since 6.0
+     */
+    void setUpdateInterval(int msec);
+
+    /**
+     * @returns for how long the changes are collected before
+     * they are applied to the model, in milliseconds
+     * @since 6.0
+     */
+    int updateInterval() const;
+
+    /**
+     * Sets approximately how much memory the results kept by the model
+     * can use. When the budget is used up, the model stops fetching
+     * more results, and in the windowed mode it keeps fewer pages
+     * in memory.
+     *
+     * Zero, the default, means that the memory use is not limited.
+     * @since 6.0
+     */
+    void setMemoryBudget(qint64 bytes);
+
+    /**
+     * @returns the memory budget of the model in bytes
+     * @since 6.0
+     */
+    qint64 memoryBudget() const;
+
+    /**
+     * @returns the estimated amount of memory in bytes that is used
+     * by the results the model currently keeps
+     * @since 6.0
+     */
+    qint64 memoryFootprint() const;
+
 public Q_SLOTS:
     /**
      * Removes the specified resource from the history
@@ -105,19 +186,36 @@ public Q_SLOTS:
     /**
      * Sort the items by title.
      *
-     * Note that this only affects the linked resources
-     * since the recently/frequently used ones have
-     * their natural order.
+     * This is the same as calling the overload with the TitleRole,
+     * the results are sorted in memory, and the saved order
+     * of the linked resources is not changed.
      *
-     * @note This requires the clientId to be specified on construction.
+     * @note Before 6.0, this did nothing.
      */
     void sortItems(Qt::SortOrder sortOrder);
 
+    /**
+     * Sort the items by the specified role. Supported roles are
+     * TitleRole, MimeType, ScoreRole, LastUpdateRole and FirstUpdateRole.
+     *
+     * The results the model has loaded are sorted in memory,
+     * and the results that come later are placed according to
+     * this order instead of the order specified by the query.
+     * Passing -1 as the role goes back to the order specified
+     * by the query.
+     *
+     * @note This is not supported in the windowed mode.
+     * @since 6.0
+     */
+    void sortItems(Qt::SortOrder sortOrder, int role);
+
 private:
     friend class ResultModelPrivate;
     ResultModelPrivate *const d;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(ResultModel::Options)
+
 } // namespace Stats
 } // namespace KActivities
 
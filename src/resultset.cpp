@@ -5,10 +5,12 @@
 */
 
 #include "resultset.h"
+#include "resultset_p.h"
 
 // Qt
 #include <QCoreApplication>
 #include <QDir>
+#include <QSet>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QUrl>
@@ -36,19 +38,22 @@ namespace Stats
 {
 using namespace Terms;
 
-class ResultSet_ResultPrivate
+ResultSet_ResultPrivate *ResultSet_ResultPrivate::get(const ResultSet::Result &result)
 {
-public:
-    QString resource;
-    QString title;
-    QString mimetype;
-    double score;
-    uint lastUpdate;
-    uint firstUpdate;
-    ResultSet::Result::LinkStatus linkStatus;
-    QStringList linkedActivities;
-    QString agent;
-};
+    return result.d;
+}
+
+const QString &ResultSet_ResultPrivate::displayString(const ResultSet::Result &result)
+{
+    auto d = get(result);
+
+    if (d->cachedDisplayString.isNull()) {
+        d->cachedDisplayString = d->title + QStringLiteral(" ") + d->resource + QStringLiteral(" - ") + QString::number(d->linkStatus) + QStringLiteral(" - ")
+            + QString::number(d->score);
+    }
+
+    return d->cachedDisplayString;
+}
 
 ResultSet::Result::Result()
     : d(new ResultSet_ResultPrivate())
@@ -87,6 +92,7 @@ ResultSet::Result::~Result()
     void ResultSet::Result::Set(Type Name)                                                                                                                     \
     {                                                                                                                                                          \
         d->Name = Name;                                                                                                                                        \
+        d->cachedDisplayString.clear();                                                                                                                        \
     }
 
 CREATE_GETTER_AND_SETTER(QString, resource, setResource)
@@ -96,11 +102,82 @@ CREATE_GETTER_AND_SETTER(double, score, setScore)
 CREATE_GETTER_AND_SETTER(uint, lastUpdate, setLastUpdate)
 CREATE_GETTER_AND_SETTER(uint, firstUpdate, setFirstUpdate)
 CREATE_GETTER_AND_SETTER(ResultSet::Result::LinkStatus, linkStatus, setLinkStatus)
-CREATE_GETTER_AND_SETTER(QStringList, linkedActivities, setLinkedActivities)
 CREATE_GETTER_AND_SETTER(QString, agent, setAgent)
 
 #undef CREATE_GETTER_AND_SETTER
 
+QStringList ResultSet::Result::linkedActivities() const
+{
+    // Most of the users never need these, so we are
+    // loading them when they are asked for
+    if (!d->linkedActivitiesLoaded) {
+        ResultSet_ResultPrivate::loadLinkedActivities({d});
+    }
+
+    return d->linkedActivities;
+}
+
+void ResultSet::Result::setLinkedActivities(QStringList activities)
+{
+    d->linkedActivities = activities;
+    d->linkedActivitiesLoaded = true;
+}
+
+void ResultSet_ResultPrivate::loadLinkedActivities(const QList<ResultSet_ResultPrivate *> &results)
+{
+    using namespace Common;
+
+    QStringList resources;
+
+    for (const auto result : results) {
+        result->linkedActivities.clear();
+        result->linkedActivitiesLoaded = true;
+
+        if (!result->resource.isEmpty()) {
+            resources << result->resource;
+        }
+    }
+
+    if (resources.isEmpty()) {
+        return;
+    }
+
+    const auto linkedActivities = details::linkedActivities(Database::instance(Database::ResourcesDatabase, Database::ReadOnly), resources);
+
+    for (const auto result : results) {
+        result->linkedActivities = linkedActivities.value(result->resource);
+    }
+}
+
+bool ResultSet_ResultPrivate::linkedActivitiesDiffer(const ResultSet::Result &left, const ResultSet::Result &right)
+{
+    const auto leftD = get(left);
+    const auto rightD = get(right);
+
+    // If one of them is not loaded, we can not know. The activities
+    // that are loaded are kept, see keepLinkedActivities
+    return leftD->linkedActivitiesLoaded && rightD->linkedActivitiesLoaded && leftD->linkedActivities != rightD->linkedActivities;
+}
+
+void ResultSet_ResultPrivate::keepLinkedActivities(ResultSet::Result &result, const ResultSet::Result &previous)
+{
+    const auto d = get(result);
+    const auto previousD = get(previous);
+
+    if (!d->linkedActivitiesLoaded && previousD->linkedActivitiesLoaded) {
+        d->linkedActivities = previousD->linkedActivities;
+        d->linkedActivitiesLoaded = true;
+    }
+}
+
+void ResultSet_ResultPrivate::forgetLinkedActivities(ResultSet::Result &result)
+{
+    const auto d = get(result);
+
+    d->linkedActivities.clear();
+    d->linkedActivitiesLoaded = false;
+}
+
 QUrl ResultSet::Result::url() const
 {
     if (QDir::isAbsolutePath(d->resource)) {
@@ -110,6 +187,81 @@ QUrl ResultSet::Result::url() const
     }
 }
 
+namespace details
+{
+namespace
+{
+// Agents, mimetypes and activities repeat a lot among the results,
+// there is no need for every result to have its own copy of them.
+// The pool is bounded in case something unexpected ends up here
+constexpr int s_maxStringPoolSize = 4096;
+
+std::mutex s_stringPoolMutex;
+QSet<QString> s_stringPool;
+
+// Whether the string shares its data with the one in the pool
+bool isInternedString(const QString &string)
+{
+    std::lock_guard<std::mutex> lock(s_stringPoolMutex);
+
+    const auto it = s_stringPool.constFind(string);
+
+    return it != s_stringPool.cend() && it->constData() == string.constData();
+}
+
+} // namespace
+
+QString internedString(const QString &string)
+{
+    if (string.isEmpty()) {
+        return QString();
+    }
+
+    std::lock_guard<std::mutex> lock(s_stringPoolMutex);
+
+    const auto it = s_stringPool.constFind(string);
+
+    if (it != s_stringPool.cend()) {
+        return *it;
+    }
+
+    if (s_stringPool.size() < s_maxStringPoolSize) {
+        s_stringPool.insert(string);
+    }
+
+    return string;
+}
+
+qint64 estimatedMemoryUsage(const ResultSet::Result &result)
+{
+    constexpr qint64 stringOverhead = 24;
+
+    const auto stringSize = [](const QString &string) {
+        return string.isEmpty() ? 0 : stringOverhead + string.capacity() * qint64(sizeof(QChar));
+    };
+
+    // The interned strings are shared between the results, so only
+    // the pointers to them count towards the result size. The ones
+    // that did not make it into the pool count in full
+    const auto sharedStringSize = [&](const QString &string) {
+        return string.isEmpty() || isInternedString(string) ? 0 : stringSize(string);
+    };
+
+    const auto d = ResultSet_ResultPrivate::get(result);
+
+    qint64 linkedActivitiesSize = d->linkedActivities.isEmpty() ? 0 : stringOverhead + d->linkedActivities.capacity() * qint64(sizeof(QString));
+    for (const auto &activity : d->linkedActivities) {
+        linkedActivitiesSize += sharedStringSize(activity);
+    }
+
+    return qint64(sizeof(ResultSet::Result)) + qint64(sizeof(ResultSet_ResultPrivate)) //
+        + stringSize(d->resource) + stringSize(d->title) + stringSize(d->cachedDisplayString) //
+        + sharedStringSize(d->mimetype) + sharedStringSize(d->agent) //
+        + linkedActivitiesSize;
+}
+
+} // namespace details
+
 class ResultSetPrivate
 {
 public:
@@ -117,7 +269,24 @@ public:
     QSqlQuery query;
     Query queryDefinition;
 
-    mutable ActivitiesSync::ConsumerPtr activities;
+    // Additional filtering of the grouped results,
+    // used for the incremental updates of the models
+    QString havingClause;
+
+    // Filter for continuing the results after a known one,
+    // so that the pages of a model can be loaded without OFFSET
+    QString seekFilter;
+    QVariantList seekValues;
+
+    QString selectionQuery() const
+    {
+        auto selection = queryDefinition.selection();
+
+        return selection == LinkedResources ? linkedResourcesQuery()
+            : selection == UsedResources    ? usedResourcesQuery()
+            : selection == AllResources     ? allResourcesQuery()
+                                            : QString();
+    }
 
     void initQuery()
     {
@@ -125,13 +294,28 @@ public:
             return;
         }
 
-        auto selection = queryDefinition.selection();
+        auto queryString = selectionQuery();
+
+        if (!seekFilter.isEmpty()) {
+            // The ordering columns can only be compared by their
+            // names in an outer query
+            queryString = QLatin1String("SELECT * FROM (") + queryString.remove(QLatin1String("ORDER_BY_CLAUSE")).remove(QLatin1String("LIMIT_CLAUSE"))
+                + QLatin1String(") WHERE ") + seekFilter + QLatin1String(" ORDER_BY_CLAUSE LIMIT_CLAUSE");
+        }
+
+        if (seekValues.isEmpty()) {
+            query = database->execQuery(replaceQueryParameters(queryString));
 
-        query = database->execQuery(replaceQueryParameters( //
-            selection == LinkedResources     ? linkedResourcesQuery()
-                : selection == UsedResources ? usedResourcesQuery()
-                : selection == AllResources  ? allResourcesQuery()
-                                             : QString()));
+        } else {
+            query = database->createQuery();
+            query.prepare(replaceQueryParameters(queryString));
+
+            for (const auto &value : std::as_const(seekValues)) {
+                query.addBindValue(value);
+            }
+
+            query.exec();
+        }
 
         if (query.lastError().isValid()) {
             qCWarning(PLASMA_ACTIVITIES_STATS_LOG) << "[Error at ResultSetPrivate::initQuery]: " << query.lastError();
@@ -154,7 +338,7 @@ public:
         }
 
         return QLatin1String("activity = '") + //
-            (activity == QLatin1String(":current") ? ActivitiesSync::currentActivity(activities) : activity) + QLatin1String("'");
+            (activity == QLatin1String(":current") ? ActivitiesSync::currentActivity() : activity) + QLatin1String("'");
     }
 
     inline QString starPattern(const QString &pattern) const
@@ -286,6 +470,7 @@ public:
         auto queryString = _query;
 
         queryString.replace(QLatin1String("ORDER_BY_CLAUSE"), QLatin1String("ORDER BY $orderingColumn resource ASC"))
+            .replace(QLatin1String("HAVING_CLAUSE"), havingClause)
             .replace(QLatin1String("LIMIT_CLAUSE"), limitOffsetSuffix());
 
         const QString replacedQuery =
@@ -339,6 +524,7 @@ public:
                 AND ($titleFilter)
 
             GROUP BY resource, title
+            HAVING_CLAUSE
 
             ORDER_BY_CLAUSE
             LIMIT_CLAUSE
@@ -380,6 +566,7 @@ public:
                 AND ($titleFilter)
 
             GROUP BY resource, title
+            HAVING_CLAUSE
 
             ORDER_BY_CLAUSE
             LIMIT_CLAUSE
@@ -476,6 +663,7 @@ public:
                     ON cr.resource = ri.targettedResource
 
                 GROUP BY resource, title
+                HAVING_CLAUSE
 
                 ORDER_BY_CLAUSE
                 LIMIT_CLAUSE
@@ -494,32 +682,15 @@ public:
 
         result.setResource(query.value(QStringLiteral("resource")).toString());
         result.setTitle(query.value(QStringLiteral("title")).toString());
-        result.setMimetype(query.value(QStringLiteral("mimetype")).toString());
+        result.setMimetype(details::internedString(query.value(QStringLiteral("mimetype")).toString()));
         result.setScore(query.value(QStringLiteral("score")).toDouble());
         result.setLastUpdate(query.value(QStringLiteral("lastUpdate")).toUInt());
         result.setFirstUpdate(query.value(QStringLiteral("firstUpdate")).toUInt());
-        result.setAgent(query.value(QStringLiteral("agent")).toString());
+        result.setAgent(details::internedString(query.value(QStringLiteral("agent")).toString()));
 
         result.setLinkStatus(static_cast<ResultSet::Result::LinkStatus>(query.value(QStringLiteral("linkStatus")).toUInt()));
 
-        auto linkedActivitiesQuery = database->createQuery();
-
-        linkedActivitiesQuery.prepare(QStringLiteral(R"(
-            SELECT usedActivity
-            FROM   ResourceLink
-            WHERE  targettedResource = :resource
-            )"));
-
-        linkedActivitiesQuery.bindValue(QStringLiteral(":resource"), result.resource());
-        linkedActivitiesQuery.exec();
-
-        QStringList linkedActivities;
-        for (const auto &item : linkedActivitiesQuery) {
-            linkedActivities << item[0].toString();
-        }
-
-        result.setLinkedActivities(linkedActivities);
-        // qDebug(PLASMA_ACTIVITIES_STATS_LOG) << result.resource() << "linked to activities" << result.linkedActivities();
+        // The linked activities are loaded when somebody asks for them
 
         return result;
     }
@@ -566,6 +737,214 @@ ResultSet::Result ResultSet::at(int index) const
     return d->currentResult();
 }
 
+namespace details
+{
+QList<ResultSet::Result> resultsUpdatedSince(const Query &query, uint timestamp)
+{
+    using namespace Common;
+
+    ResultSetPrivate d;
+    d.database = Database::instance(Database::ResourcesDatabase, Database::ReadOnly);
+    d.queryDefinition = query;
+
+    // The timestamps have the resolution of one second, so we are also
+    // returning the results updated in the same second as the last one we saw
+    d.havingClause = QLatin1String("HAVING MAX(lastUpdate) >= ") + QString::number(timestamp);
+
+    d.initQuery();
+
+    QList<ResultSet::Result> results;
+
+    while (d.query.next()) {
+        results << d.currentResult();
+    }
+
+    return results;
+}
+
+int countResults(const Query &query)
+{
+    using namespace Common;
+
+    ResultSetPrivate d;
+    d.database = Database::instance(Database::ResourcesDatabase, Database::ReadOnly);
+    d.queryDefinition = query;
+
+    if (!d.database) {
+        return 0;
+    }
+
+    auto queryString = d.selectionQuery();
+    queryString.remove(QLatin1String("ORDER_BY_CLAUSE")).remove(QLatin1String("LIMIT_CLAUSE"));
+
+    auto countQuery = d.database->execQuery(d.replaceQueryParameters(QLatin1String("SELECT COUNT(*) FROM (") + queryString + QLatin1String(")")));
+
+    return countQuery.next() ? countQuery.value(0).toInt() : 0;
+}
+
+bool canSeekAfter(const Query &query, const ResultSet::Result &result)
+{
+    // Missing scores and timestamps are NULL in the database, and zero
+    // in the result, so we can not know where the zeros are in the order
+    switch (query.ordering()) {
+    case HighScoredFirst:
+        return result.score() != 0;
+    case RecentlyUsedFirst:
+        return result.lastUpdate() != 0;
+    case RecentlyCreatedFirst:
+        return result.firstUpdate() != 0;
+    default:
+        return true;
+    }
+}
+
+QList<ResultSet::Result> resultsAfter(const Query &query, const ResultSet::Result &result)
+{
+    using namespace Common;
+
+    ResultSetPrivate d;
+    d.database = Database::instance(Database::ResourcesDatabase, Database::ReadOnly);
+    d.queryDefinition = query;
+
+    // Follows the ORDER_BY_CLAUSE - linkStatus DESC, the ordering column,
+    // and resource ASC. The NULL values come last in the descending order
+    const auto ordering = query.ordering();
+
+    const QString column = ordering == HighScoredFirst ? QStringLiteral("score")
+        : ordering == RecentlyUsedFirst                ? QStringLiteral("lastUpdate")
+        : ordering == RecentlyCreatedFirst             ? QStringLiteral("firstUpdate")
+        : ordering == OrderByTitle                     ? QStringLiteral("title")
+                                                       : QString();
+
+    const QVariant value = ordering == HighScoredFirst ? QVariant(result.score())
+        : ordering == RecentlyUsedFirst                ? QVariant(result.lastUpdate())
+        : ordering == RecentlyCreatedFirst             ? QVariant(result.firstUpdate())
+        : ordering == OrderByTitle                     ? QVariant(result.title())
+                                                       : QVariant();
+
+    if (column.isEmpty()) {
+        d.seekFilter = QStringLiteral("(linkStatus < ? OR (linkStatus = ? AND resource > ?))");
+        d.seekValues = {int(result.linkStatus()), int(result.linkStatus()), result.resource()};
+
+    } else {
+        const QString after = ordering == OrderByTitle ? QStringLiteral("%1 > ?") : QStringLiteral("(%1 < ? OR %1 IS NULL)");
+
+        d.seekFilter = QStringLiteral("(linkStatus < ? OR (linkStatus = ? AND (%1 OR (%2 = ? AND resource > ?))))").arg(after.arg(column), column);
+        d.seekValues = {int(result.linkStatus()), int(result.linkStatus()), value, value, result.resource()};
+    }
+
+    d.initQuery();
+
+    QList<ResultSet::Result> results;
+
+    while (d.query.next()) {
+        results << d.currentResult();
+    }
+
+    return results;
+}
+
+QSet<QString> survivingResources(const Query &query, const QStringList &resources)
+{
+    using namespace Common;
+
+    QSet<QString> result;
+
+    ResultSetPrivate d;
+    d.database = Database::instance(Database::ResourcesDatabase, Database::ReadOnly);
+    d.queryDefinition = query;
+
+    if (!d.database || resources.isEmpty()) {
+        return result;
+    }
+
+    // We only care whether the resources still have their stats or links,
+    // the other filters of the query do not depend on them
+    QStringList sources;
+
+    if (query.selection() != LinkedResources) {
+        sources << QStringLiteral(R"(
+            SELECT targettedResource as resource
+                 , usedActivity      as activity
+                 , initiatingAgent   as agent
+            FROM   ResourceScoreCache
+            )");
+    }
+
+    if (query.selection() != UsedResources) {
+        sources << QStringLiteral(R"(
+            SELECT targettedResource as resource
+                 , usedActivity      as activity
+                 , initiatingAgent   as agent
+            FROM   ResourceLink
+            )");
+    }
+
+    forEachParameterBatch(resources, [&](const QStringList &batch, const QString &placeholders) {
+        auto survivingQuery = d.database->createQuery();
+
+        survivingQuery.prepare(d.replaceQueryParameters(QStringLiteral(R"(
+            SELECT DISTINCT resource
+            FROM (%1)
+            WHERE
+                ($agentsFilter)
+                AND ($activitiesFilter)
+                AND resource IN (%2)
+            )")
+                                                            .arg(sources.join(QStringLiteral(" UNION ALL ")), placeholders)));
+
+        for (const auto &resource : batch) {
+            survivingQuery.addBindValue(resource);
+        }
+
+        survivingQuery.exec();
+
+        if (survivingQuery.lastError().isValid()) {
+            qCWarning(PLASMA_ACTIVITIES_STATS_LOG) << "[Error at survivingResources]: " << survivingQuery.lastError();
+        }
+
+        for (const auto &item : survivingQuery) {
+            result << item[0].toString();
+        }
+    });
+
+    return result;
+}
+
+QHash<QString, QStringList> linkedActivities(const Common::Database::Ptr &database, const QStringList &resources)
+{
+    QHash<QString, QStringList> result;
+
+    if (!database) {
+        return result;
+    }
+
+    Common::forEachParameterBatch(resources, [&](const QStringList &batch, const QString &placeholders) {
+        auto linkedActivitiesQuery = database->createQuery();
+
+        linkedActivitiesQuery.prepare(QStringLiteral(R"(
+            SELECT targettedResource, usedActivity
+            FROM   ResourceLink
+            WHERE  targettedResource IN (%1)
+            )")
+                                          .arg(placeholders));
+
+        for (const auto &resource : batch) {
+            linkedActivitiesQuery.addBindValue(resource);
+        }
+
+        linkedActivitiesQuery.exec();
+
+        for (const auto &item : linkedActivitiesQuery) {
+            result[item[0].toString()] << internedString(item[1].toString());
+        }
+    });
+
+    return result;
+}
+
+} // namespace details
+
 } // namespace Stats
 } // namespace KActivities
 
@@ -71,7 +71,12 @@ public:
         uint lastUpdate() const; ///< Timestamp of the last update
         uint firstUpdate() const; ///< Timestamp of the first update
         LinkStatus linkStatus() const; ///< Differentiates between linked and non-linked resources in mixed queries
-        QStringList linkedActivities() const; ///< Contains the activities this resource is linked to for the queries that care about resource linking
+        /**
+         * Contains the activities this resource is linked to for the queries that care about resource linking.
+         * @note Since 6.0, these are loaded from the database when they are first asked for,
+         * in the caller's thread, unless they were set with setLinkedActivities
+         */
+        QStringList linkedActivities() const;
         QString agent() const; /// Contains the initiating agent for this resource
 
         void setResource(QString resource);
@@ -86,6 +91,7 @@ public:
 
     private:
         ResultSet_ResultPrivate *d;
+        friend class ResultSet_ResultPrivate;
     };
 
     /**
@@ -0,0 +1,127 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef KACTIVITIES_STATS_RESULTSET_P_H
+#define KACTIVITIES_STATS_RESULTSET_P_H
+
+#include "resultset.h"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+
+#include <common/database/Database.h>
+
+namespace KActivities
+{
+namespace Stats
+{
+class ResultSet_ResultPrivate
+{
+public:
+    QString resource;
+    QString title;
+    QString mimetype;
+    double score;
+    uint lastUpdate;
+    uint firstUpdate;
+    ResultSet::Result::LinkStatus linkStatus;
+    QStringList linkedActivities;
+    bool linkedActivitiesLoaded = false;
+    QString agent;
+
+    // Derived from the fields above, calculated when it is first
+    // needed, and cleared when any of the fields changes
+    QString cachedDisplayString;
+
+    static ResultSet_ResultPrivate *get(const ResultSet::Result &result);
+
+    /**
+     * Returns the string that ResultModel shows for the Qt::DisplayRole
+     */
+    static const QString &displayString(const ResultSet::Result &result);
+
+    /**
+     * Loads the linked activities for all the results with one query,
+     * in the caller's thread
+     */
+    static void loadLinkedActivities(const QList<ResultSet_ResultPrivate *> &results);
+
+    /**
+     * Compares the linked activities without loading them.
+     * They only differ if they are loaded in both results.
+     */
+    static bool linkedActivitiesDiffer(const ResultSet::Result &left, const ResultSet::Result &right);
+
+    /**
+     * Copies the linked activities from the previous version of the result,
+     * if they are loaded there and not in the result
+     */
+    static void keepLinkedActivities(ResultSet::Result &result, const ResultSet::Result &previous);
+
+    /**
+     * Marks the linked activities as not loaded, after the links
+     * of the resource have changed
+     */
+    static void forgetLinkedActivities(ResultSet::Result &result);
+};
+
+namespace details
+{
+/**
+ * Returns a copy of the string that shares its data with the other
+ * copies of the same string. Meant for the values that repeat often.
+ */
+QString internedString(const QString &string);
+
+/**
+ * Returns approximately how many bytes the result takes in memory
+ */
+qint64 estimatedMemoryUsage(const ResultSet::Result &result);
+
+/**
+ * Returns the results of the query that were updated at, or after,
+ * the specified time. The offset and limit of the query are respected.
+ */
+QList<ResultSet::Result> resultsUpdatedSince(const Query &query, uint timestamp);
+
+/**
+ * Returns the number of results of the query, ignoring its offset and limit
+ */
+int countResults(const Query &query);
+
+/**
+ * Returns whether the position of the result in the query ordering
+ * is known well enough to continue the results after it
+ */
+bool canSeekAfter(const Query &query, const ResultSet::Result &result);
+
+/**
+ * Returns the results that come after the specified one in the query
+ * ordering, without skipping over the preceding ones like OFFSET does.
+ * The limit of the query is respected, the offset should be zero.
+ * @note Check canSeekAfter before calling this
+ */
+QList<ResultSet::Result> resultsAfter(const Query &query, const ResultSet::Result &result);
+
+/**
+ * Returns which of the resources still have usage statistics or links
+ * for the agents and activities of the query.
+ */
+QSet<QString> survivingResources(const Query &query, const QStringList &resources);
+
+/**
+ * Returns the activities each of the resources is linked to.
+ * The resources that are not linked are not included.
+ */
+QHash<QString, QStringList> linkedActivities(const Common::Database::Ptr &database, const QStringList &resources);
+
+} // namespace details
+} // namespace Stats
+} // namespace KActivities
+
+#endif // KACTIVITIES_STATS_RESULTSET_P_H
@@ -0,0 +1,157 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "resultsnapshot_p.h"
+
+// Qt
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "plasma-activities-stats-logsettings.h"
+
+using KActivities::Stats::Query;
+using KActivities::Stats::ResultSet;
+
+namespace ResultSnapshot
+{
+namespace
+{
+constexpr quint32 s_magic = 0x4b415353; // KASS
+constexpr quint32 s_version = 1;
+
+QString snapshotPath(const QString &name)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/plasma-activities-stats/") + name
+        + QStringLiteral(".snapshot");
+}
+
+QString sortedList(QStringList list)
+{
+    list.sort();
+    list.removeDuplicates();
+    return list.join(QLatin1Char(','));
+}
+
+} // namespace
+
+QString name(const QString &clientId, const Query &query)
+{
+    // The offset is not a part of the name, the model always starts from the beginning
+    const QString normalized = QStringList{
+        clientId,
+        QString::number(query.selection()),
+        sortedList(query.types()),
+        sortedList(query.agents()),
+        sortedList(query.activities()),
+        sortedList(query.urlFilters()),
+        sortedList(query.titleFilters()),
+        QString::number(query.ordering()),
+        QString::number(query.limit()),
+        query.dateStart().toString(Qt::ISODate),
+        query.dateEnd().toString(Qt::ISODate),
+    }.join(QLatin1Char('\n'));
+
+    return QString::fromLatin1(QCryptographicHash::hash(normalized.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+QList<ResultSet::Result> load(const QString &name)
+{
+    QList<ResultSet::Result> results;
+
+    QFile file(snapshotPath(name));
+
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+        return results;
+    }
+
+    // Mapping the file saves us from copying it before parsing,
+    // the strings are copied out of it by QDataStream anyway
+    const auto data = file.map(0, file.size());
+
+    if (!data) {
+        return results;
+    }
+
+    const auto bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(data), file.size());
+    QDataStream stream(bytes);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+
+    stream >> magic >> version >> count;
+
+    if (magic == s_magic && version == s_version) {
+        results.reserve(qMin<quint32>(count, 1000));
+
+        for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            QString resource;
+            QString title;
+            QString mimetype;
+            QString agent;
+            double score = 0;
+            quint32 lastUpdate = 0;
+            quint32 firstUpdate = 0;
+            quint8 linkStatus = 0;
+
+            stream >> resource >> title >> mimetype >> agent >> score >> lastUpdate >> firstUpdate >> linkStatus;
+
+            ResultSet::Result result;
+            result.setResource(resource);
+            result.setTitle(title);
+            result.setMimetype(mimetype);
+            result.setAgent(agent);
+            result.setScore(score);
+            result.setLastUpdate(lastUpdate);
+            result.setFirstUpdate(firstUpdate);
+            result.setLinkStatus(static_cast<ResultSet::Result::LinkStatus>(linkStatus));
+
+            results << result;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "Ignoring the invalid snapshot" << file.fileName();
+        results.clear();
+    }
+
+    file.unmap(data);
+
+    return results;
+}
+
+void save(const QString &name, const QList<ResultSet::Result> &results)
+{
+    const QString path = snapshotPath(name);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    stream << s_magic << s_version << quint32(results.size());
+
+    for (const auto &result : results) {
+        stream << result.resource() << result.title() << result.mimetype() << result.agent() << result.score() << quint32(result.lastUpdate())
+               << quint32(result.firstUpdate()) << quint8(result.linkStatus());
+    }
+
+    file.commit();
+}
+
+} // namespace ResultSnapshot
@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef RESULT_SNAPSHOT_P_H
+#define RESULT_SNAPSHOT_P_H
+
+#include <QList>
+#include <QString>
+
+#include "query.h"
+#include "resultset.h"
+
+namespace ResultSnapshot
+{
+/**
+ * Returns the name of the snapshot for the client and the query.
+ * Queries that differ only in the order of their terms
+ * share the same snapshot. The ':current' activity needs to be
+ * replaced by the actual one, otherwise all the activities
+ * would share the snapshot.
+ */
+QString name(const QString &clientId, const KActivities::Stats::Query &query);
+
+/**
+ * Loads the results saved in the snapshot. Returns an empty list
+ * if there is no snapshot, or if it is not valid.
+ */
+QList<KActivities::Stats::ResultSet::Result> load(const QString &name);
+
+/**
+ * Saves the results to the snapshot, replacing the old one.
+ * This writes to the disk, so the model calls it from the worker thread.
+ */
+void save(const QString &name, const QList<KActivities::Stats::ResultSet::Result> &results);
+
+} // namespace ResultSnapshot
+
+#endif // RESULT_SNAPSHOT_P_H
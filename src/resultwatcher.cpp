@@ -8,12 +8,15 @@
 
 // Qt
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QList>
-#include <QRegularExpression>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QTimer>
 
 // Local
+#include "plasma-activities-stats-invalidation-logsettings.h"
 #include "plasma-activities-stats-logsettings.h"
 #include <common/database/Database.h>
 #include <utils/debug_and_return.h>
@@ -28,10 +31,11 @@
 #include <plasmaactivities/consumer.h>
 
 #include "activitiessync_p.h"
+#include "resourceinfocache_p.h"
 #include "common/dbus/common.h"
 #include "common/specialvalues.h"
 #include "resourceslinking_interface.h"
-#include "resourcesscoring_interface.h"
+#include "resultwatcherhub_p.h"
 #include "utils/lazy_val.h"
 #include "utils/qsqlquery_iterator.h"
 
@@ -45,25 +49,40 @@ namespace Stats
 {
 // Main class
 
-class ResultWatcherPrivate
+class ResultWatcherPrivate : public ResultWatcherHub::Listener
 {
 public:
-    mutable ActivitiesSync::ConsumerPtr activities;
-    QList<QRegularExpression> urlFilters;
+    QList<Common::StarPatternMatcher> urlFilters;
 
     ResultWatcherPrivate(ResultWatcher *parent, Query query)
-        : linking(KAMD_DBUS_SERVICE, QStringLiteral("/ActivityManager/Resources/Linking"), QDBusConnection::sessionBus(), nullptr)
-        , scoring(KAMD_DBUS_SERVICE, QStringLiteral("/ActivityManager/Resources/Scoring"), QDBusConnection::sessionBus(), nullptr)
-        , q(parent)
+        : q(parent)
         , query(query)
     {
         for (const auto &urlFilter : query.urlFilters()) {
-            urlFilters << Common::starPatternToRegex(urlFilter);
+            urlFilters << Common::StarPatternMatcher(urlFilter);
         }
 
         m_resultInvalidationTimer.setSingleShot(true);
-        m_resultInvalidationTimer.setInterval(200);
-        QObject::connect(&m_resultInvalidationTimer, &QTimer::timeout, q, Q_EMIT & ResultWatcher::resultsInvalidated);
+        QObject::connect(&m_resultInvalidationTimer, &QTimer::timeout, q, [this] {
+            invalidateResults();
+        });
+
+        ResultWatcherHub::addListener(this);
+    }
+
+    ~ResultWatcherPrivate() override
+    {
+        ResultWatcherHub::removeListener(this);
+    }
+
+    QStringList watchedAgents() const override
+    {
+        return query.agents();
+    }
+
+    QStringList watchedActivities() const override
+    {
+        return query.activities();
     }
 
     template<typename Collection, typename Predicate>
@@ -92,7 +111,7 @@ public:
                                              activity == ANY_ACTIVITY_TAG || any_of(query.activities(), [&](const QString &matcher) {
                                                  return matcher == ANY_ACTIVITY_TAG ? true
                                                      : matcher == CURRENT_ACTIVITY_TAG
-                                                     ? (matcher == activity || activity == ActivitiesSync::currentActivity(activities))
+                                                     ? (matcher == activity || activity == ActivitiesSync::cachedCurrentActivity())
                                                      : activity == matcher;
                                              }));
     }
@@ -116,36 +135,22 @@ public:
     bool urlMatches(const QString &url) const
     {
 #if DEBUG_MATCHERS
-        qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "Url " << url << "matching against" << urlFilters;
+        qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "Url " << url << "matching against" << query.urlFilters();
 #endif
 
-        return kamd::utils::debug_and_return(DEBUG_MATCHERS, " -> returning ", any_of(urlFilters, [&](const QRegularExpression &matcher) {
-                                                 return matcher.match(url).hasMatch();
+        return kamd::utils::debug_and_return(DEBUG_MATCHERS, " -> returning ", any_of(urlFilters, [&](const Common::StarPatternMatcher &matcher) {
+                                                 return matcher.matches(url);
                                              }));
     }
 
     bool typeMatches(const QString &resource) const
     {
         // We don't necessarily need to retrieve the type from
-        // the database. If we do, get it only once
+        // the database. If we do, get it only once. The recently
+        // used resources are usually already in the cache
         auto type = kamd::utils::make_lazy_val([&]() -> QString {
-            using Common::Database;
-
-            auto database = Database::instance(Database::ResourcesDatabase, Database::ReadOnly);
-
-            if (!database) {
-                return QString();
-            }
-
-            auto query = database->execQuery(QStringLiteral("SELECT mimetype FROM ResourceInfo WHERE "
-                                                            "targettedResource = '")
-                                             + resource + QStringLiteral("'"));
-
-            for (const auto &item : query) {
-                return item[0].toString();
-            }
-
-            return QString();
+            const auto info = ResourceInfoCache::find(resource);
+            return info ? info->mimetype : QString();
         });
 
 #if DEBUG_MATCHERS
@@ -176,7 +181,7 @@ public:
                                              agentMatches(agent) && activityMatches(activity) && urlMatches(resource) && typeMatches(resource));
     }
 
-    void onResourceLinkedToActivity(const QString &agent, const QString &resource, const QString &activity)
+    void onResourceLinkedToActivity(const QString &agent, const QString &resource, const QString &activity) override
     {
 #if DEBUG_MATCHERS
         qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "Resource has been linked: " << agent << resource << activity;
@@ -193,10 +198,10 @@ public:
 
         // TODO: See whether it makes sense to have
         //       lastUpdate/firstUpdate here as well
-        Q_EMIT q->resultLinked(resource);
+        pushChange({Change::Linked, resource});
     }
 
-    void onResourceUnlinkedFromActivity(const QString &agent, const QString &resource, const QString &activity)
+    void onResourceUnlinkedFromActivity(const QString &agent, const QString &resource, const QString &activity) override
     {
 #if DEBUG_MATCHERS
         qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "Resource unlinked: " << agent << resource << activity;
@@ -211,12 +216,13 @@ public:
             return;
         }
 
-        Q_EMIT q->resultUnlinked(resource);
+        pushChange({Change::Unlinked, resource});
     }
 
 #undef DEBUG_MATCHERS
 
-    void onResourceScoreUpdated(const QString &activity, const QString &agent, const QString &resource, double score, uint lastUpdate, uint firstUpdate)
+    void
+    onResourceScoreUpdated(const QString &activity, const QString &agent, const QString &resource, double score, uint lastUpdate, uint firstUpdate) override
     {
         Q_ASSERT_X(activity == QLatin1String("00000000-0000-0000-0000-000000000000") || !QUuid(activity).isNull(),
                    "ResultWatcher::onResourceScoreUpdated",
@@ -231,30 +237,47 @@ public:
             return;
         }
 
-        Q_EMIT q->resultScoreUpdated(resource, score, lastUpdate, firstUpdate);
+        pushChange({Change::ScoreUpdated, resource, QString(), score, lastUpdate, firstUpdate});
     }
 
-    void onEarlierStatsDeleted(QString, int)
+    void onEarlierStatsDeleted(const QString &, int) override
     {
         // The linked resources do not really care about the stats
         if (query.selection() == Terms::LinkedResources) {
             return;
         }
 
-        scheduleResultsInvalidation();
+        pushChange({Change::Invalidated});
     }
 
-    void onRecentStatsDeleted(QString, int, QString)
+    void onRecentStatsDeleted(const QString &, int, const QString &) override
     {
         // The linked resources do not really care about the stats
         if (query.selection() == Terms::LinkedResources) {
             return;
         }
 
-        scheduleResultsInvalidation();
+        pushChange({Change::Invalidated});
     }
 
-    void onStatsForResourceDeleted(const QString &activity, const QString &agent, const QString &resource)
+    // These are reported for all the resources, whether they
+    // match the query or not, see the ResultWatcher documentation
+    void onResourceTitleChanged(const QString &resource, const QString &title) override
+    {
+        pushChange({Change::TitleChanged, resource, title});
+    }
+
+    void onResourceMimetypeChanged(const QString &resource, const QString &mimetype) override
+    {
+        pushChange({Change::MimetypeChanged, resource, mimetype});
+    }
+
+    void onChangesMissed() override
+    {
+        pushChange({Change::Missed});
+    }
+
+    void onStatsForResourceDeleted(const QString &activity, const QString &agent, const QString &resource) override
     {
         if (query.selection() == Terms::LinkedResources) {
             return;
@@ -262,28 +285,179 @@ public:
 
         if (activityMatches(activity) && agentMatches(agent)) {
             if (resource.contains(QLatin1Char('*'))) {
-                scheduleResultsInvalidation();
+                pushChange({Change::Invalidated});
 
             } else if (typeMatches(resource)) {
+                pushChange({Change::Removed, resource});
+            }
+        }
+    }
+
+    //_ The events are matched in the hub's thread, and the resulting
+    // changes are passed to our thread through a queue
+    struct Change {
+        enum Type {
+            Linked,
+            Unlinked,
+            ScoreUpdated,
+            Removed,
+            TitleChanged,
+            MimetypeChanged,
+            Invalidated,
+            Missed,
+        };
+
+        Type type;
+        QString resource;
+        // The new title or mimetype
+        QString value;
+        double score = 0;
+        uint lastUpdate = 0;
+        uint firstUpdate = 0;
+    };
+
+    ResultWatcherHub::EventQueue<Change> changes;
+
+    void pushChange(Change change)
+    {
+        // We only need to ask for the changes to be applied
+        // if there were none waiting in the queue
+        if (changes.push(std::move(change))) {
+            QMetaObject::invokeMethod(
+                q,
+                [this] {
+                    applyChanges();
+                },
+                Qt::QueuedConnection);
+        }
+    }
+
+    void applyChanges()
+    {
+        // Only the last score update for a resource matters,
+        // unless something else has happened to it in between
+        QList<Change> coalesced;
+        QHash<QString, qsizetype> lastChangeFor;
+
+        for (auto &change : changes.takeAll()) {
+            if (change.type == Change::ScoreUpdated) {
+                const auto last = lastChangeFor.constFind(change.resource);
+
+                if (last != lastChangeFor.cend() && coalesced[*last].type == Change::ScoreUpdated) {
+                    coalesced[*last] = std::move(change);
+                    continue;
+                }
+            }
+
+            if (!change.resource.isEmpty()) {
+                lastChangeFor[change.resource] = coalesced.size();
+            }
+
+            coalesced << std::move(change);
+        }
+
+        for (const auto &change : std::as_const(coalesced)) {
+            switch (change.type) {
+            case Change::Linked:
+                Q_EMIT q->resultLinked(change.resource);
+                break;
+
+            case Change::Unlinked:
+                Q_EMIT q->resultUnlinked(change.resource);
+                break;
+
+            case Change::ScoreUpdated:
+                Q_EMIT q->resultScoreUpdated(change.resource, change.score, change.lastUpdate, change.firstUpdate);
+                break;
+
+            case Change::Removed:
                 if (!m_resultInvalidationTimer.isActive()) {
                     // Remove a result only if we haven't an invalidation
                     // request scheduled
-                    q->resultRemoved(resource);
+                    Q_EMIT q->resultRemoved(change.resource);
                 }
+                break;
+
+            case Change::TitleChanged:
+                Q_EMIT q->resourceTitleChanged(change.resource, change.value);
+                break;
+
+            case Change::MimetypeChanged:
+                Q_EMIT q->resourceMimetypeChanged(change.resource, change.value);
+                break;
+
+            case Change::Invalidated:
+                scheduleResultsInvalidation();
+                break;
+
+            case Change::Missed:
+                Q_EMIT q->changesMissed();
+                break;
             }
         }
     }
+    //^
+
+    //_ Lets not send a lot of invalidation events at once.
+    // The first event after a quiet period invalidates the results
+    // immediately. If the events keep coming, we are waiting longer
+    // and longer before the next invalidation, but never longer
+    // than the maximum latency since the first postponed event
+    static constexpr int s_initialInvalidationDelay = 50;
+    static constexpr int s_maxInvalidationDelay = 1600;
+    static constexpr int s_maxInvalidationLatency = 2000;
 
-    // Lets not send a lot of invalidation events at once
     QTimer m_resultInvalidationTimer;
+    int m_resultInvalidationDelay = s_initialInvalidationDelay;
+
+    // Since the last event, and since the first postponed one
+    QElapsedTimer m_sinceLastInvalidationEvent;
+    QElapsedTimer m_sincePostponedInvalidation;
+
+    // How many events were coalesced into each invalidation
+    int m_coalescedInvalidationEvents = 0;
+    quint64 m_totalInvalidationEvents = 0;
+    quint64 m_totalInvalidations = 0;
+
     void scheduleResultsInvalidation()
     {
-        QDBG << "Scheduling invalidation";
-        m_resultInvalidationTimer.start();
+        const bool isQuiet = !m_sinceLastInvalidationEvent.isValid() || m_sinceLastInvalidationEvent.elapsed() > m_resultInvalidationDelay;
+
+        m_sinceLastInvalidationEvent.start();
+        ++m_totalInvalidationEvents;
+        ++m_coalescedInvalidationEvents;
+
+        if (!m_resultInvalidationTimer.isActive() && isQuiet) {
+            m_resultInvalidationDelay = s_initialInvalidationDelay;
+            invalidateResults();
+            return;
+        }
+
+        if (!m_resultInvalidationTimer.isActive()) {
+            m_sincePostponedInvalidation.start();
+        }
+
+        const auto remainingLatency = s_maxInvalidationLatency - m_sincePostponedInvalidation.elapsed();
+
+        m_resultInvalidationTimer.start(int(qBound<qint64>(0, remainingLatency, m_resultInvalidationDelay)));
+        m_resultInvalidationDelay = qMin(m_resultInvalidationDelay * 2, s_maxInvalidationDelay);
     }
 
-    org::kde::ActivityManager::ResourcesLinking linking;
-    org::kde::ActivityManager::ResourcesScoring scoring;
+    void invalidateResults()
+    {
+        m_resultInvalidationTimer.stop();
+        ++m_totalInvalidations;
+
+        // Enabled with QT_LOGGING_RULES="kde.plasma.activitiesstats.invalidation.info=true"
+        qCInfo(PLASMA_ACTIVITIES_STATS_INVALIDATION_LOG) << "ResultWatcher(" << (void *)this << ") invalidating the results after"
+                                                         << m_coalescedInvalidationEvents << "events," << m_totalInvalidationEvents << "events and"
+                                                         << m_totalInvalidations << "invalidations in total";
+
+        m_coalescedInvalidationEvents = 0;
+
+        Q_EMIT q->resultsInvalidated();
+    }
+    //^
 
     ResultWatcher *const q;
     Query query;
@@ -293,29 +467,8 @@ ResultWatcher::ResultWatcher(Query query, QObject *parent)
     : QObject(parent)
     , d(new ResultWatcherPrivate(this, query))
 {
-    using namespace org::kde::ActivityManager;
-    using namespace std::placeholders;
-
-    // There is no need for private slots, when we have bind
-
-    // Connecting the linking service
-    QObject::connect(&d->linking,
-                     &ResourcesLinking::ResourceLinkedToActivity,
-                     this,
-                     std::bind(&ResultWatcherPrivate::onResourceLinkedToActivity, d, _1, _2, _3));
-    QObject::connect(&d->linking,
-                     &ResourcesLinking::ResourceUnlinkedFromActivity,
-                     this,
-                     std::bind(&ResultWatcherPrivate::onResourceUnlinkedFromActivity, d, _1, _2, _3));
-
-    // Connecting the scoring service
-    QObject::connect(&d->scoring,
-                     &ResourcesScoring::ResourceScoreUpdated,
-                     this,
-                     std::bind(&ResultWatcherPrivate::onResourceScoreUpdated, d, _1, _2, _3, _4, _5, _6));
-    QObject::connect(&d->scoring, &ResourcesScoring::ResourceScoreDeleted, this, std::bind(&ResultWatcherPrivate::onStatsForResourceDeleted, d, _1, _2, _3));
-    QObject::connect(&d->scoring, &ResourcesScoring::RecentStatsDeleted, this, std::bind(&ResultWatcherPrivate::onRecentStatsDeleted, d, _1, _2, _3));
-    QObject::connect(&d->scoring, &ResourcesScoring::EarlierStatsDeleted, this, std::bind(&ResultWatcherPrivate::onEarlierStatsDeleted, d, _1, _2));
+    // The signals are delivered by the hub that all the watchers share,
+    // it also keeps the cached titles and mimetypes up to date
 }
 
 ResultWatcher::~ResultWatcher()
@@ -332,7 +485,7 @@ void ResultWatcher::linkToActivity(const QUrl &resource, const Terms::Activity &
 
     for (const auto &activity : activities) {
         for (const auto &agent : agents) {
-            d->linking.LinkResourceToActivity(agent, resource.toString(), activity);
+            ResultWatcherHub::linking().LinkResourceToActivity(agent, resource.toString(), activity);
         }
     }
 }
@@ -347,7 +500,7 @@ void ResultWatcher::unlinkFromActivity(const QUrl &resource, const Terms::Activi
     for (const auto &activity : activities) {
         for (const auto &agent : agents) {
             qCDebug(PLASMA_ACTIVITIES_STATS_LOG) << "Unlink " << agent << resource << activity;
-            d->linking.UnlinkResourceFromActivity(agent, resource.toString(), activity);
+            ResultWatcherHub::linking().UnlinkResourceFromActivity(agent, resource.toString(), activity);
         }
     }
 }
@@ -88,6 +88,16 @@ Q_SIGNALS:
      */
     void resultsInvalidated();
 
+    /**
+     * Emitted when the watcher might have missed some of the changes,
+     * for example while the activity manager was being restarted.
+     * Unlike with resultsInvalidated, the results the client has
+     * are still valid, only the ones that were updated in the meantime
+     * need to be reloaded.
+     * @since 6.0
+     */
+    void changesMissed();
+
 public:
     void linkToActivity(const QUrl &resource,
                         const Terms::Activity &activity = Terms::Activity(QStringList()),
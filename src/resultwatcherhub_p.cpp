@@ -0,0 +1,877 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "resultwatcherhub_p.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusServiceWatcher>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QList>
+#include <QThread>
+#include <QTimer>
+
+// STL
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Local
+#include "activitiessync_p.h"
+#include "common/database/Database.h"
+#include "common/database/schema/ResourcesDatabaseSchema.h"
+#include "common/dbus/common.h"
+#include "common/specialvalues.h"
+#include "resourceslinking_interface.h"
+#include "resourceinfocache_p.h"
+#include "resourcesscoring_interface.h"
+#include <utils/qsqlquery_iterator.h>
+
+namespace ResultWatcherHub
+{
+namespace
+{
+using namespace org::kde::ActivityManager;
+
+// The score updates are not received through the proxy, we need
+// the match rules that filter them by the activity and agent
+class ScoreUpdatesReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    std::function<void(const QDBusMessage &)> handler;
+
+public Q_SLOTS:
+    void onResourceScoreUpdated(const QDBusMessage &message)
+    {
+        handler(message);
+    }
+};
+
+struct Hub {
+    static QString busName()
+    {
+        return QStringLiteral("PlasmaActivitiesStats-watchers");
+    }
+
+    Hub()
+        // The signals are received through a separate connection, in a separate
+        // thread, so that a storm of them does not keep the main thread busy
+        : bus(QDBusConnection::connectToBus(QDBusConnection::SessionBus, busName()))
+        , linkingCalls(KAMD_DBUS_SERVICE, QStringLiteral("/ActivityManager/Resources/Linking"), QDBusConnection::sessionBus(), nullptr)
+        , linking(KAMD_DBUS_SERVICE, QStringLiteral("/ActivityManager/Resources/Linking"), bus, nullptr)
+        , scoring(KAMD_DBUS_SERVICE, QStringLiteral("/ActivityManager/Resources/Scoring"), bus, nullptr)
+    {
+        thread.setObjectName(QStringLiteral("PlasmaActivitiesStats watchers"));
+
+        context.moveToThread(&thread);
+        linking.moveToThread(&thread);
+        scoring.moveToThread(&thread);
+        scoreUpdatesReceiver.moveToThread(&thread);
+        missedChangesTimer.moveToThread(&thread);
+        serviceWatcher.moveToThread(&thread);
+        databaseWatcher.moveToThread(&thread);
+        databaseChangeTimer.moveToThread(&thread);
+
+        // The mimetypes are looked up in the thread, it keeps its
+        // database connection open, and closes it when it finishes
+        QObject::connect(
+            &thread,
+            &QThread::started,
+            &thread,
+            [this] {
+                openDatabase();
+            },
+            Qt::DirectConnection);
+        QObject::connect(
+            &thread,
+            &QThread::finished,
+            &thread,
+            [this] {
+                database.reset();
+            },
+            Qt::DirectConnection);
+
+        QObject::connect(&linking,
+                         &ResourcesLinking::ResourceLinkedToActivity,
+                         &context,
+                         [this](const QString &agent, const QString &resource, const QString &activity) {
+                             dispatch(candidates(agent, activity), &Listener::onResourceLinkedToActivity, agent, resource, activity);
+                         });
+        QObject::connect(&linking,
+                         &ResourcesLinking::ResourceUnlinkedFromActivity,
+                         &context,
+                         [this](const QString &agent, const QString &resource, const QString &activity) {
+                             dispatch(candidates(agent, activity), &Listener::onResourceUnlinkedFromActivity, agent, resource, activity);
+                         });
+
+        scoreUpdatesReceiver.handler = [this](const QDBusMessage &message) {
+            onResourceScoreUpdated(message);
+        };
+
+        QObject::connect(&scoring,
+                         &ResourcesScoring::ResourceScoreDeleted,
+                         &context,
+                         [this](const QString &activity, const QString &agent, const QString &resource) {
+                             dispatch(candidates(agent, activity), &Listener::onStatsForResourceDeleted, activity, agent, resource);
+                         });
+        QObject::connect(&scoring, &ResourcesScoring::RecentStatsDeleted, &context, [this](const QString &activity, int count, const QString &what) {
+            dispatch(allListeners(), &Listener::onRecentStatsDeleted, activity, count, what);
+        });
+        QObject::connect(&scoring, &ResourcesScoring::EarlierStatsDeleted, &context, [this](const QString &activity, int months) {
+            dispatch(allListeners(), &Listener::onEarlierStatsDeleted, activity, months);
+        });
+
+        missedChangesTimer.setSingleShot(true);
+        missedChangesTimer.setInterval(s_missedChangesGracePeriod);
+        QObject::connect(&missedChangesTimer, &QTimer::timeout, &context, [this] {
+            checkForMissedChanges();
+        });
+
+        databaseChangeTimer.setSingleShot(true);
+        databaseChangeTimer.setInterval(s_databaseChangeDelay);
+        QObject::connect(&databaseChangeTimer, &QTimer::timeout, &context, [this] {
+            checkResourceInfo();
+        });
+
+        QObject::connect(&databaseWatcher, &QFileSystemWatcher::fileChanged, &context, [this] {
+            onDatabaseChanged();
+        });
+        QObject::connect(&databaseWatcher, &QFileSystemWatcher::directoryChanged, &context, [this] {
+            onDatabaseChanged();
+        });
+
+        // The signals sent while the activity manager was
+        // restarting might have been lost
+        QObject::connect(&serviceWatcher, &QDBusServiceWatcher::serviceOwnerChanged, &context, [this] {
+            missedChangesTimer.start();
+        });
+
+        thread.start(QThread::LowPriority);
+    }
+
+    ~Hub()
+    {
+        thread.quit();
+        thread.wait();
+
+        // The interfaces still hold the connection, it is closed when they are gone
+        QDBusConnection::disconnectFromBus(busName());
+    }
+
+    // Guards the listeners, the index and the match rules.
+    // It is not held while the listeners are being called
+    std::recursive_mutex mutex;
+
+    typedef QList<Listener *> Listeners;
+
+    // Each listener is called while its own mutex is held, so that removing
+    // it waits only for the call in progress, if there is one, and not
+    // for the calls to all the other listeners
+    struct Slot {
+        explicit Slot(Listener *listener)
+            : listener(listener)
+        {
+        }
+
+        Listener *const listener;
+        std::recursive_mutex mutex;
+        // Guarded by the mutex of the slot
+        bool alive = true;
+    };
+    QHash<Listener *, std::shared_ptr<Slot>> slots;
+
+    //_ Index of the listeners by the agents and activities they are
+    // interested in. The listeners that accept any agent or activity
+    // are under ':any', the ones that follow the current activity
+    // are under ':current', since it can change at any time
+    QHash<QString, QHash<QString, Listeners>> index;
+
+    // The keys each listener was indexed under
+    struct Keys {
+        QStringList agents;
+        QStringList activities;
+    };
+    QHash<Listener *, Keys> listeners;
+
+    static QStringList agentKeys(const Listener *listener)
+    {
+        const auto agents = listener->watchedAgents();
+
+        if (agents.isEmpty() || agents.contains(ANY_AGENT_TAG)) {
+            return {ANY_AGENT_TAG};
+        }
+
+        QStringList result;
+        for (const auto &agent : agents) {
+            // The current agent does not change
+            result << (agent == CURRENT_AGENT_TAG ? QCoreApplication::applicationName() : agent);
+        }
+        result.removeDuplicates();
+        return result;
+    }
+
+    static QStringList activityKeys(const Listener *listener)
+    {
+        const auto activities = listener->watchedActivities();
+
+        if (activities.isEmpty() || activities.contains(ANY_ACTIVITY_TAG)) {
+            return {ANY_ACTIVITY_TAG};
+        }
+
+        auto result = activities;
+        result.removeDuplicates();
+        return result;
+    }
+
+    void add(Listener *listener)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+
+        const Keys keys{agentKeys(listener), activityKeys(listener)};
+        listeners[listener] = keys;
+        slots[listener] = std::make_shared<Slot>(listener);
+
+        for (const auto &rule : scoreRules(keys)) {
+            addScoreRule(rule);
+        }
+
+        for (const auto &agent : keys.agents) {
+            auto &agentIndex = index[agent];
+            for (const auto &activity : keys.activities) {
+                agentIndex[activity] << listener;
+            }
+        }
+    }
+
+    void remove(Listener *listener)
+    {
+        std::shared_ptr<Slot> slot;
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+
+            if (!listeners.contains(listener)) {
+                return;
+            }
+
+            slot = slots.take(listener);
+            unindex(listener);
+        }
+
+        // The hub's thread might be calling the listener right now
+        std::lock_guard<std::recursive_mutex> slotLock(slot->mutex);
+        slot->alive = false;
+    }
+
+    // Called with the mutex held
+    void unindex(Listener *listener)
+    {
+        const auto keys = listeners.take(listener);
+        const auto &activities = keys.activities;
+
+        changeTracking.remove(listener);
+
+        for (const auto &rule : scoreRules(keys)) {
+            removeScoreRule(rule);
+        }
+
+        for (const auto &agent : keys.agents) {
+            auto &agentIndex = index[agent];
+            for (const auto &activity : activities) {
+                agentIndex[activity].removeOne(listener);
+                if (agentIndex[activity].isEmpty()) {
+                    agentIndex.remove(activity);
+                }
+            }
+            if (agentIndex.isEmpty()) {
+                index.remove(agent);
+            }
+        }
+    }
+    //^
+
+    Listeners allListeners()
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+
+        return listeners.keys();
+    }
+
+    // The listeners that might be interested in the event
+    Listeners candidates(const QString &agent, const QString &activity)
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+
+        // The events for any agent or activity need to go to everyone
+        if (agent == ANY_AGENT_TAG || activity == ANY_ACTIVITY_TAG) {
+            return allListeners();
+        }
+
+        Listeners result;
+
+        const auto collect = [&](const QString &agentKey) {
+            const auto agentIndex = index.constFind(agentKey);
+            if (agentIndex == index.cend()) {
+                return;
+            }
+
+            for (const auto &activityKey : {activity, ANY_ACTIVITY_TAG, CURRENT_ACTIVITY_TAG}) {
+                const auto bucket = agentIndex->constFind(activityKey);
+                if (bucket == agentIndex->cend()) {
+                    continue;
+                }
+
+                for (const auto &listener : *bucket) {
+                    // A listener can be in more than one of the buckets
+                    if (!result.contains(listener)) {
+                        result << listener;
+                    }
+                }
+            }
+        };
+
+        collect(agent);
+        collect(ANY_AGENT_TAG);
+
+        return result;
+    }
+
+    //_ Score updates are sent for every resource that is used anywhere
+    // in the system. Instead of receiving them all and filtering them
+    // here, we are asking the bus to only send us the ones for the
+    // activities and agents the listeners are interested in.
+    // A rule is an activity and an agent, null matches any value
+    typedef std::pair<QString, QString> ScoreRule;
+    QHash<ScoreRule, int> scoreRuleUsers;
+    ScoreUpdatesReceiver scoreUpdatesReceiver;
+
+    // Overlapping rules deliver the same message more than once
+    QString lastScoreUpdateSender;
+    uint lastScoreUpdateSerial = 0;
+
+    static QList<ScoreRule> scoreRules(const Keys &keys)
+    {
+        // The special values can not be matched on the bus,
+        // the current activity changes, the others match
+        // more than one value
+        const auto concrete = [](const QString &key) {
+            return key.startsWith(QLatin1Char(':')) ? QString() : key;
+        };
+
+        QList<ScoreRule> result;
+        for (const auto &activity : keys.activities) {
+            for (const auto &agent : keys.agents) {
+                const ScoreRule rule{concrete(activity), concrete(agent)};
+                if (!result.contains(rule)) {
+                    result << rule;
+                }
+            }
+        }
+        return result;
+    }
+
+    // The rules are on the hub's connection, so that the messages
+    // are delivered in its thread, like the other signals
+    bool connectScoreRule(const ScoreRule &rule, bool connect)
+    {
+        const auto path = QStringLiteral("/ActivityManager/Resources/Scoring");
+        const auto interface = QStringLiteral("org.kde.ActivityManager.ResourcesScoring");
+        const auto name = QStringLiteral("ResourceScoreUpdated");
+        // arg0 is the activity, arg1 the agent, the null ones are not matched
+        const QStringList arguments{rule.first, rule.second};
+
+        return connect ? bus.connect(KAMD_DBUS_SERVICE, path, interface, name, arguments, QString(), &scoreUpdatesReceiver, SLOT(onResourceScoreUpdated(QDBusMessage)))
+                       : bus.disconnect(KAMD_DBUS_SERVICE, path, interface, name, arguments, QString(), &scoreUpdatesReceiver, SLOT(onResourceScoreUpdated(QDBusMessage)));
+    }
+
+    void addScoreRule(const ScoreRule &rule)
+    {
+        if (scoreRuleUsers[rule]++ == 0) {
+            connectScoreRule(rule, true);
+        }
+    }
+
+    void removeScoreRule(const ScoreRule &rule)
+    {
+        if (--scoreRuleUsers[rule] == 0) {
+            scoreRuleUsers.remove(rule);
+            connectScoreRule(rule, false);
+        }
+    }
+
+    void onResourceScoreUpdated(const QDBusMessage &message)
+    {
+        if (message.serial() == lastScoreUpdateSerial && message.service() == lastScoreUpdateSender) {
+            return;
+        }
+
+        lastScoreUpdateSerial = message.serial();
+        lastScoreUpdateSender = message.service();
+
+        const auto arguments = message.arguments();
+
+        if (arguments.size() != 6) {
+            return;
+        }
+
+        const auto activity = arguments[0].toString();
+        const auto agent = arguments[1].toString();
+
+        dispatch(candidates(agent, activity),
+                 &Listener::onResourceScoreUpdated,
+                 activity,
+                 agent,
+                 arguments[2].toString(),
+                 arguments[3].toDouble(),
+                 arguments[4].toUInt(),
+                 arguments[5].toUInt());
+    }
+    //^
+
+    // The database does not exist until the activity manager creates it.
+    // If it could not be opened when the thread started, we are trying
+    // again when the activity manager appears, and when the listeners
+    // are added. Called in the hub's thread
+    bool openDatabase()
+    {
+        if (database) {
+            return true;
+        }
+
+        database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadOnly);
+
+        if (!database) {
+            return false;
+        }
+
+        knownDataVersion = database->dataVersion();
+        resourceInfoDataVersion = knownDataVersion;
+        updateResourceInfoWatermarks();
+        watchDatabase();
+
+        // The listeners added before this did not get their baselines
+        for (const auto &listener : allListeners()) {
+            scheduleBaseline(listener);
+        }
+
+        return true;
+    }
+
+    //_ The signals sent while the activity manager was restarting are lost.
+    // SQLite changes the data version of our connection whenever another
+    // connection commits a change to the database. If it has changed, we
+    // are checking whether the rows the listeners are interested in have
+    // changed as well, and telling the listeners that did not receive any
+    // signals since the previous check that they might have missed something.
+    // This is not exact, the signals might come for some of the changes
+    // and not for the others, but it does not bother the listeners
+    // with the changes that are not theirs.
+    static constexpr int s_missedChangesGracePeriod = 1000;
+
+    qint64 knownDataVersion = -1;
+    QTimer missedChangesTimer;
+    QDBusServiceWatcher serviceWatcher{KAMD_DBUS_SERVICE, QDBusConnection::sessionBus(), QDBusServiceWatcher::WatchForOwnerChange};
+
+    struct ChangeTracking {
+        // Summary of the rows the listener is interested in, it changes
+        // when they do, see fingerprint
+        QString fingerprint;
+        // The current activity the fingerprint was taken for
+        QString currentActivity;
+        // Whether the listener has received any signals since then
+        bool signalled = false;
+    };
+    // Guarded by the mutex, the listeners without the tracking
+    // were added after the last check
+    QHash<Listener *, ChangeTracking> changeTracking;
+
+    // These are called in the hub's thread
+    QString fingerprint(const Keys &keys, const QString &currentActivity) const
+    {
+        QStringList conditions;
+        QStringList values;
+
+        const auto addCondition = [&](const QString &column, const QStringList &columnKeys, const QString &anyTag) {
+            if (columnKeys.contains(anyTag)) {
+                return;
+            }
+
+            QStringList placeholders;
+            for (const auto &key : columnKeys) {
+                values << (key == CURRENT_ACTIVITY_TAG ? currentActivity : key);
+                placeholders << QStringLiteral("?");
+            }
+
+            conditions << column + QStringLiteral(" IN (") + placeholders.join(QLatin1Char(',')) + QLatin1Char(')');
+        };
+
+        addCondition(QStringLiteral("initiatingAgent"), keys.agents, ANY_AGENT_TAG);
+        addCondition(QStringLiteral("usedActivity"), keys.activities, ANY_ACTIVITY_TAG);
+
+        const auto where = conditions.isEmpty() ? QString() : QStringLiteral(" WHERE ") + conditions.join(QStringLiteral(" AND "));
+
+        // The score changes whenever a resource is used, the counts
+        // change when the stats are deleted and the resources linked
+        auto query = database->createQuery();
+        query.prepare(QStringLiteral("SELECT (SELECT COUNT(*) || ':' || IFNULL(MAX(lastUpdate), 0) || ':' || TOTAL(cachedScore) FROM ResourceScoreCache")
+                      + where + QStringLiteral("), (SELECT COUNT(*) FROM ResourceLink") + where + QStringLiteral(")"));
+
+        for (int i = 0; i < 2; ++i) {
+            for (const auto &value : values) {
+                query.addBindValue(value);
+            }
+        }
+
+        if (!query.exec() || !query.next()) {
+            return QString();
+        }
+
+        return query.value(0).toString() + QLatin1Char('|') + query.value(1).toString();
+    }
+
+    void takeBaseline(Listener *listener)
+    {
+        if (!openDatabase()) {
+            return;
+        }
+
+        const auto currentActivity = ActivitiesSync::currentActivity();
+
+        Keys keys;
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+
+            if (!listeners.contains(listener)) {
+                return;
+            }
+
+            keys = listeners[listener];
+        }
+
+        const auto listenerFingerprint = fingerprint(keys, currentActivity);
+
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+
+        if (listeners.contains(listener)) {
+            changeTracking[listener] = ChangeTracking{listenerFingerprint, currentActivity, false};
+        }
+    }
+
+    void checkForMissedChanges()
+    {
+        if (!openDatabase()) {
+            return;
+        }
+
+        const auto dataVersion = database->dataVersion();
+
+        if (dataVersion == knownDataVersion) {
+            return;
+        }
+
+        knownDataVersion = dataVersion;
+
+        const auto currentActivity = ActivitiesSync::currentActivity();
+
+        QHash<Listener *, Keys> trackedListeners;
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+
+            for (auto it = changeTracking.cbegin(); it != changeTracking.cend(); ++it) {
+                trackedListeners[it.key()] = listeners.value(it.key());
+            }
+        }
+
+        // Many listeners have the same keys, the database
+        // is asked only once for each of them
+        QHash<QString, QString> fingerprints;
+        QHash<Listener *, QString> newFingerprints;
+
+        for (auto it = trackedListeners.cbegin(); it != trackedListeners.cend(); ++it) {
+            const auto &keys = it.value();
+            const auto keysId = keys.agents.join(QLatin1Char(',')) + QLatin1Char('/') + keys.activities.join(QLatin1Char(','));
+
+            auto listenerFingerprint = fingerprints.constFind(keysId);
+            if (listenerFingerprint == fingerprints.cend()) {
+                listenerFingerprint = fingerprints.insert(keysId, fingerprint(keys, currentActivity));
+            }
+
+            newFingerprints[it.key()] = *listenerFingerprint;
+        }
+
+        Listeners missed;
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+
+            for (auto it = newFingerprints.cbegin(); it != newFingerprints.cend(); ++it) {
+                const auto tracking = changeTracking.find(it.key());
+
+                // The listener has been removed in the meantime
+                if (tracking == changeTracking.end()) {
+                    continue;
+                }
+
+                // When the current activity changes, the listeners that
+                // follow it load everything again, they need a new baseline
+                if (tracking->fingerprint != it.value() && tracking->currentActivity == currentActivity && !tracking->signalled) {
+                    missed << it.key();
+                }
+
+                *tracking = ChangeTracking{it.value(), currentActivity, false};
+            }
+        }
+
+        dispatch(missed, &Listener::onChangesMissed);
+    }
+
+    //_ The activity manager does not send signals when the title or
+    // the mimetype of a resource changes. We are watching the database
+    // for commits instead, and comparing what the database has with
+    // the cached information for the recently used resources.
+    // The table has no modification time, and the titles are updated
+    // in place, so the rows of all the cached resources are compared.
+    // The rows added since the last check are the only ones that can
+    // be for the resources that the database did not know about
+    static constexpr int s_databaseChangeDelay = 250;
+
+    // The database is in the WAL mode, the commits only write
+    // to the write-ahead log file, not to the database file itself
+    const QString walPath = Common::ResourcesDatabaseSchema::path() + QStringLiteral("-wal");
+
+    QFileSystemWatcher databaseWatcher;
+    QTimer databaseChangeTimer;
+    qint64 resourceInfoDataVersion = -1;
+    qint64 resourceInfoRowIdWatermark = 0;
+
+    // These are called in the hub's thread
+    void watchDatabase()
+    {
+        // The log file is removed and created again from time to time,
+        // the directory is watched so that we notice when it comes back
+        const auto directory = QFileInfo(walPath).absolutePath();
+
+        if (!databaseWatcher.directories().contains(directory)) {
+            databaseWatcher.addPath(directory);
+        }
+
+        if (!databaseWatcher.files().contains(walPath) && QFile::exists(walPath)) {
+            databaseWatcher.addPath(walPath);
+        }
+    }
+
+    void onDatabaseChanged()
+    {
+        watchDatabase();
+
+        // Not restarting the timer, the changes should
+        // not be delayed indefinitely while they keep coming
+        if (!databaseChangeTimer.isActive()) {
+            databaseChangeTimer.start();
+        }
+    }
+
+    void updateResourceInfoWatermarks()
+    {
+        if (!database) {
+            return;
+        }
+
+        resourceInfoRowIdWatermark = database->value(QStringLiteral("SELECT IFNULL(MAX(rowid), 0) FROM ResourceInfo")).toLongLong();
+    }
+
+    void checkResourceInfo()
+    {
+        if (!database) {
+            return;
+        }
+
+        // The file also changes when nothing was committed,
+        // for example when the log is checkpointed
+        const auto dataVersion = database->dataVersion();
+
+        if (dataVersion == resourceInfoDataVersion) {
+            return;
+        }
+
+        resourceInfoDataVersion = dataVersion;
+
+        const auto rowIdWatermark = resourceInfoRowIdWatermark;
+
+        // Taken before reading the changes, the rows that are added in
+        // the meantime are read again next time, which does not hurt
+        updateResourceInfoWatermarks();
+
+        // The cache has at most a thousand resources,
+        // they are read in a couple of queries
+        auto infos = ResourceInfoCache::loadFromDatabase(database, ResourceInfoCache::cachedResources());
+
+        auto query = database->createQuery();
+        query.prepare(QStringLiteral(R"(
+            SELECT targettedResource, title, mimetype
+            FROM   ResourceInfo
+            WHERE  rowid > :rowId
+            )"));
+        query.bindValue(QStringLiteral(":rowId"), rowIdWatermark);
+        query.exec();
+
+        for (const auto &item : query) {
+            infos[item[0].toString()] = ResourceInfoCache::Info{item[1].toString(), item[2].toString()};
+        }
+
+        for (auto it = infos.cbegin(); it != infos.cend(); ++it) {
+            const auto &resource = it.key();
+            const auto &info = it.value();
+            const auto cachedInfo = ResourceInfoCache::cached(resource);
+
+            // The database did not know about the resource when it was looked up
+            if (!cachedInfo && ResourceInfoCache::isCachedAsMissing(resource)) {
+                ResourceInfoCache::insert(resource, info);
+                dispatch(allListeners(), &Listener::onResourceTitleChanged, resource, info.title);
+                dispatch(allListeners(), &Listener::onResourceMimetypeChanged, resource, info.mimetype);
+                continue;
+            }
+
+            if (!cachedInfo) {
+                continue;
+            }
+
+            if (info.title != cachedInfo->title) {
+                ResourceInfoCache::updateTitle(resource, info.title);
+                dispatch(allListeners(), &Listener::onResourceTitleChanged, resource, info.title);
+            }
+
+            if (info.mimetype != cachedInfo->mimetype) {
+                ResourceInfoCache::updateMimetype(resource, info.mimetype);
+                dispatch(allListeners(), &Listener::onResourceMimetypeChanged, resource, info.mimetype);
+            }
+        }
+    }
+    //^
+
+    // This can be called from any thread
+    void scheduleBaseline(Listener *listener)
+    {
+        QMetaObject::invokeMethod(
+            &context,
+            [this, listener] {
+                takeBaseline(listener);
+            },
+            Qt::QueuedConnection);
+    }
+    //^
+
+    template<typename Method, typename... Args>
+    void dispatch(const Listeners &candidates, Method method, const Args &...args)
+    {
+        // The listeners match the current activity with the cached value.
+        // If it is not known yet, asking for it might block for a while
+        ActivitiesSync::currentActivity();
+
+        QList<std::shared_ptr<Slot>> targets;
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+
+            targets.reserve(candidates.size());
+
+            for (const auto &listener : candidates) {
+                const auto slot = slots.value(listener);
+
+                if (!slot) {
+                    continue;
+                }
+
+                targets << slot;
+
+                const auto tracking = changeTracking.find(listener);
+                if (tracking != changeTracking.end()) {
+                    tracking->signalled = true;
+                }
+            }
+        }
+
+        for (const auto &slot : std::as_const(targets)) {
+            std::lock_guard<std::recursive_mutex> slotLock(slot->mutex);
+
+            // The listener might have been removed in the meantime
+            if (slot->alive) {
+                (slot->listener->*method)(args...);
+            }
+        }
+    }
+
+    QThread thread;
+    Common::Database::Ptr database;
+
+    QDBusConnection bus;
+    ResourcesLinking linkingCalls;
+
+    // These live in the hub's thread
+    QObject context;
+    ResourcesLinking linking;
+    ResourcesScoring scoring;
+};
+
+Hub *s_hub = nullptr;
+
+void cleanup()
+{
+    delete std::exchange(s_hub, nullptr);
+}
+
+Hub *hub()
+{
+    Q_ASSERT_X(!QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread(),
+               "ResultWatcherHub",
+               "The result watchers need to live in the main thread");
+
+    if (!s_hub) {
+        s_hub = new Hub();
+        qAddPostRoutine(cleanup);
+    }
+
+    return s_hub;
+}
+
+} // namespace
+
+void addListener(Listener *listener)
+{
+    hub()->add(listener);
+
+    // The other listeners are not checked, adding
+    // a listener does not change anything for them
+    s_hub->scheduleBaseline(listener);
+}
+
+void removeListener(Listener *listener)
+{
+    if (!s_hub) {
+        return;
+    }
+
+    s_hub->remove(listener);
+}
+
+ResourcesLinking &linking()
+{
+    return hub()->linkingCalls;
+}
+
+} // namespace ResultWatcherHub
+
+#include "resultwatcherhub_p.moc"
@@ -0,0 +1,160 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef RESULT_WATCHER_HUB_P_H
+#define RESULT_WATCHER_HUB_P_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace org
+{
+namespace kde
+{
+namespace ActivityManager
+{
+class ResourcesLinking;
+}
+}
+}
+
+namespace ResultWatcherHub
+{
+/**
+ * Receives the signals of the activity manager's resources services.
+ *
+ * The signals are received and matched in the hub's thread, and the
+ * listener methods are called in it as well. They should only do the
+ * matching, and pass the results to the listener's own thread.
+ */
+class Listener
+{
+public:
+    virtual ~Listener() = default;
+
+    /**
+     * The agents and activities the listener is interested in, as they
+     * are specified in its query. They are read only when the listener
+     * is added, the signals for the other agents and activities do not
+     * reach it. The listener still needs to check the values itself.
+     */
+    virtual QStringList watchedAgents() const = 0;
+    virtual QStringList watchedActivities() const = 0;
+
+    virtual void onResourceLinkedToActivity(const QString &agent, const QString &resource, const QString &activity) = 0;
+    virtual void onResourceUnlinkedFromActivity(const QString &agent, const QString &resource, const QString &activity) = 0;
+
+    virtual void
+    onResourceScoreUpdated(const QString &activity, const QString &agent, const QString &resource, double score, uint lastUpdate, uint firstUpdate) = 0;
+    virtual void onStatsForResourceDeleted(const QString &activity, const QString &agent, const QString &resource) = 0;
+    virtual void onRecentStatsDeleted(const QString &activity, int count, const QString &what) = 0;
+    virtual void onEarlierStatsDeleted(const QString &activity, int months) = 0;
+
+    /**
+     * Called for the resources that are in ResourceInfoCache,
+     * when their title or mimetype in the database changes
+     */
+    virtual void onResourceTitleChanged(const QString &resource, const QString &title) = 0;
+    virtual void onResourceMimetypeChanged(const QString &resource, const QString &mimetype) = 0;
+
+    /**
+     * Called when the rows of the database the listener is interested in
+     * have changed, and the listener did not receive any signals since
+     * the previous check. The checks are done after the activity manager
+     * restarts, the signals it sends in the meantime are lost.
+     */
+    virtual void onChangesMissed() = 0;
+};
+
+/**
+ * Subscribes the listener to the signals. All the listeners in the process
+ * share the same D-Bus proxies, so each signal is received and unmarshalled
+ * only once, and then passed on to the listeners.
+ *
+ * @note The listeners need to live in the main thread
+ */
+void addListener(Listener *listener);
+
+/**
+ * Unsubscribes the listener. If the hub's thread is passing a signal
+ * to the listener at the moment, this waits until it is done, but
+ * not for the signal to be passed to the other listeners.
+ */
+void removeListener(Listener *listener);
+
+/**
+ * The shared proxy for linking the resources to activities.
+ * Unlike the listeners, it lives in the main thread.
+ */
+org::kde::ActivityManager::ResourcesLinking &linking();
+
+/**
+ * Passes the values from one thread to another without locking.
+ * Any thread can push the values, only one can take them.
+ */
+template<typename T>
+class EventQueue
+{
+public:
+    EventQueue() = default;
+    EventQueue(const EventQueue &) = delete;
+    EventQueue &operator=(const EventQueue &) = delete;
+
+    ~EventQueue()
+    {
+        takeAll();
+    }
+
+    /**
+     * Returns whether the queue was empty before, so that the caller
+     * knows whether it needs to ask for the values to be taken
+     */
+    bool push(T value)
+    {
+        auto node = new Node{std::move(value), m_head.load(std::memory_order_relaxed)};
+
+        while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) { }
+
+        return node->next == nullptr;
+    }
+
+    /**
+     * Takes all the values, in the order they were pushed in
+     */
+    QList<T> takeAll()
+    {
+        // The nodes are linked from the newest to the oldest
+        auto node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+        QList<T> result;
+
+        while (node) {
+            result << std::move(node->value);
+            delete std::exchange(node, node->next);
+        }
+
+        std::reverse(result.begin(), result.end());
+
+        return result;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node *next;
+    };
+
+    std::atomic<Node *> m_head{nullptr};
+};
+
+} // namespace ResultWatcherHub
+
+#endif // RESULT_WATCHER_HUB_P_H
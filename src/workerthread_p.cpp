@@ -0,0 +1,100 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "workerthread_p.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <mutex>
+#include <utility>
+
+namespace WorkerThread
+{
+namespace
+{
+struct Worker {
+    QThread thread;
+    QObject context;
+
+    // The connections are only cached while somebody holds them,
+    // so the worker holds its own for as long as it runs. Otherwise
+    // every job would open the database and set it up again
+    Common::Database::Ptr database;
+};
+
+std::mutex s_workerMutex;
+Worker *s_worker = nullptr;
+
+void cleanup()
+{
+    Worker *worker = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(s_workerMutex);
+        worker = std::exchange(s_worker, nullptr);
+    }
+
+    if (!worker) {
+        return;
+    }
+
+    // The jobs that are already queued, like saving the snapshots
+    // of the models that were destroyed, are finished first
+    QMetaObject::invokeMethod(&worker->context, [] {}, Qt::BlockingQueuedConnection);
+
+    worker->thread.quit();
+    worker->thread.wait();
+
+    delete worker;
+}
+
+} // namespace
+
+QObject *instance()
+{
+    std::lock_guard<std::mutex> lock(s_workerMutex);
+
+    if (!s_worker) {
+        s_worker = new Worker();
+        s_worker->thread.setObjectName(QStringLiteral("PlasmaActivitiesStats worker"));
+        s_worker->context.moveToThread(&s_worker->thread);
+
+        // The connection is opened and closed in the worker thread
+        const auto worker = s_worker;
+        QObject::connect(
+            &worker->thread,
+            &QThread::started,
+            &worker->thread,
+            [worker] {
+                worker->database = Common::Database::instance(Common::Database::ResourcesDatabase, Common::Database::ReadOnly);
+            },
+            Qt::DirectConnection);
+        QObject::connect(
+            &worker->thread,
+            &QThread::finished,
+            &worker->thread,
+            [worker] {
+                worker->database.reset();
+            },
+            Qt::DirectConnection);
+
+        s_worker->thread.start(QThread::LowPriority);
+
+        qAddPostRoutine(cleanup);
+    }
+
+    return &s_worker->context;
+}
+
+Common::Database::Ptr database()
+{
+    Q_ASSERT_X(QThread::currentThread() == instance()->thread(), "WorkerThread::database", "This can only be called from the worker thread");
+
+    return s_worker->database;
+}
+
+} // namespace WorkerThread
@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent(at)local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef WORKER_THREAD_P_H
+#define WORKER_THREAD_P_H
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <common/database/Database.h>
+
+namespace WorkerThread
+{
+/**
+ * The object living in the thread that the library uses
+ * for background database access.
+ */
+QObject *instance();
+
+/**
+ * The read-only database connection of the worker thread. It stays
+ * open while the thread runs, the jobs that use Database::instance
+ * get the same connection.
+ * @note This can only be called from the worker thread.
+ */
+Common::Database::Ptr database();
+
+/**
+ * Runs the job in the worker thread. Use QFuture::then with
+ * a context object to process the result in the caller's thread.
+ */
+template<typename Job>
+auto run(Job &&job) -> QFuture<std::invoke_result_t<Job>>
+{
+    using Result = std::invoke_result_t<Job>;
+
+    auto promise = std::make_shared<QPromise<Result>>();
+    auto future = promise->future();
+
+    promise->start();
+
+    QMetaObject::invokeMethod(
+        instance(),
+        [promise, job = std::forward<Job>(job)]() mutable {
+            promise->addResult(job());
+            promise->finish();
+        },
+        Qt::QueuedConnection);
+
+    return future;
+}
+
+} // namespace WorkerThread
+
+#endif // WORKER_THREAD_P_H